@@ -0,0 +1,71 @@
+// Compares the in-place stream decoder against the previous nlohmann::json feed path.
+#include "bnb/marketData/BNBStreamDecoder.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+    const std::vector<std::string> BOOK_TICKER_PAYLOADS = {
+        R"({"u":400900217,"s":"BNBUSDT","b":"25.35190000","B":"31.21000000","a":"25.36520000","A":"40.66000000"})",
+        R"({"u":400900218,"s":"BTCUSDT","b":"63012.01000000","B":"0.51200000","a":"63012.02000000","A":"1.20300000"})",
+        R"({"u":400900219,"s":"ETHBTC","b":"0.05312000","B":"12.40000000","a":"0.05313000","A":"3.98000000"})",
+    };
+
+    InstrumentRegistry registry;
+
+    // Feed path before the in-place decoder: payload copy, DOM, control checks, stod on string copies.
+    BookTickerMDFrame legacyParse(const std::string& message) {
+        std::string payload = message;
+        auto json_data = nlohmann::json::parse(payload);
+        if (json_data.contains("error") || json_data.contains("id")) {
+            throw std::runtime_error("unexpected control message");
+        }
+        BookTickerMDFrame dataFrame;
+        dataFrame.instrumentId = registry.find(json_data["s"].get<std::string>());
+        dataFrame.bestBidPrice = Price::fromDouble(std::stod(json_data["b"].get<std::string>()));
+        dataFrame.bestBidQty = Qty::fromDouble(std::stod(json_data["B"].get<std::string>()));
+        dataFrame.bestAskPrice = Price::fromDouble(std::stod(json_data["a"].get<std::string>()));
+        dataFrame.bestAskQty = Qty::fromDouble(std::stod(json_data["A"].get<std::string>()));
+        return dataFrame;
+    }
+
+    BookTickerMDFrame fastParse(const std::string& message) {
+        BookTickerMDFrame dataFrame;
+        if (BNBStreamDecoder::decode(message, registry, dataFrame) != DecodeResult::FRAME) {
+            throw std::runtime_error("decode failed");
+        }
+        return dataFrame;
+    }
+
+    template <typename Parser>
+    void runBenchmark(const std::string& name, size_t iterations, Parser&& parser) {
+        double checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            auto frame = parser(BOOK_TICKER_PAYLOADS[i % BOOK_TICKER_PAYLOADS.size()]);
+            checksum += frame.bestBidPrice.toDouble();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        double nsPerMessage = static_cast<double>(elapsed) / iterations;
+        std::cout << std::left << std::setw(12) << name
+                  << std::right << std::setw(14) << std::fixed << std::setprecision(0) << (1e9 / nsPerMessage) << " msg/s"
+                  << std::setw(10) << std::setprecision(1) << nsPerMessage << " ns/msg"
+                  << "  (checksum " << checksum << ")" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = (argc > 1) ? std::stoul(argv[1]) : 2000000;
+    for (const char* symbol : {"BNBUSDT", "BTCUSDT", "ETHBTC"}) {
+        registry.add(symbol);
+    }
+    std::cout << "bookTicker decode, " << iterations << " messages" << std::endl;
+
+    runBenchmark("nlohmann", iterations, legacyParse);
+    runBenchmark("in-place", iterations, fastParse);
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Compares the pre-keyed signer and direct JSON writing against the previous signed request path.
+#include "bnb/utils/BNBRequests/RequestsBuilder.h"
+#include "bnb/utils/BNBRequests/HmacSigner.h"
+#include "bnb/utils/BNBRequests/OrderTemplate.h"
+#include <nlohmann/json.hpp>
+#include <openssl/hmac.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+    // Key and payload of the Binance HMAC signing example
+    const std::string API_KEY = "vmPUZE6mv9SD5VNHk4HlWFsOr6aKE2zvsw0MuIgwCIPy6utIco14y7Ju91duEh8A";
+    const std::string SECRET_KEY = "NhqPtmdSJYdKjVHjA7PZj4Mge3R5YNiP1e3UZjInClVN65XAbvqqM6A7H5fATj0j";
+
+    std::map<std::string, std::string> orderParams() {
+        return {
+            {"symbol", "BTCUSDT"},
+            {"side", "SELL"},
+            {"type", "LIMIT"},
+            {"timeInForce", "GTC"},
+            {"quantity", "0.01000000"},
+            {"price", "52000.00"},
+            {"newOrderRespType", "ACK"},
+            {"recvWindow", "100"}
+        };
+    }
+
+    // Signed request path before the signer: fmt pairs joined, one-shot HMAC, sprintf hex, DOM dump.
+    size_t legacyRequest(std::map<std::string, std::string> params) {
+        params["timestamp"] = RequestsHelper::getTimestamp();
+        params.insert({"apiKey", API_KEY});
+        std::vector<std::string> paramList;
+        for (const auto& param : params) {
+            paramList.push_back(fmt::format("{}={}", param.first, param.second));
+        }
+        std::string payload = fmt::format("{}", fmt::join(paramList, "&"));
+        unsigned char* digest = HMAC(EVP_sha256(), SECRET_KEY.c_str(), SECRET_KEY.length(), (unsigned char*)payload.c_str(), payload.length(), NULL, NULL);
+        char mdString[SHA256_DIGEST_LENGTH * 2 + 1];
+        for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+            sprintf(&mdString[i * 2], "%02x", (unsigned int)digest[i]);
+        }
+        params.insert({"signature", std::string(mdString)});
+        nlohmann::json requestBody = {
+            {"id", "e9d6b4c8-2b2a-4a8e-9d0a-5f0c2c7e1a3b"},
+            {"method", "order.place"},
+            {"params", params}
+        };
+        return requestBody.dump().size();
+    }
+
+    size_t fastRequest(std::map<std::string, std::string> params) {
+        return RequestsBuilder::paramsSignedRequest("order.place", params).second.size();
+    }
+
+    template <typename Function>
+    void runBenchmark(const std::string& name, size_t iterations, Function&& function) {
+        size_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            checksum += function();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        double nsPerCall = static_cast<double>(elapsed) / iterations;
+        std::cout << std::left << std::setw(16) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(1) << nsPerCall << " ns/request"
+                  << "  (checksum " << checksum << ")" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = (argc > 1) ? std::stoul(argv[1]) : 500000;
+    RequestsBuilder::getInstance(API_KEY, "HMAC", SECRET_KEY);
+    const std::map<std::string, std::string> params = orderParams();
+
+    std::string payload;
+    RequestsHelper::appendQueryString(payload, params);
+    HmacSigner signer(SECRET_KEY);
+    char signature[HmacSigner::SIGNATURE_CHARS];
+    OrderTemplate orderTemplate("order.place", "BTCUSDT", Way::SELL, OrderType::LIMIT,
+                                {{"timeInForce", "GTC"}, {"newOrderRespType", "ACK"}, {"recvWindow", "100"}});
+    const Qty quantity = Qty::fromDouble(0.01);
+    const Price price = Price::fromDouble(52000);
+
+    std::cout << "order.place signing, " << iterations << " requests" << std::endl;
+    runBenchmark("legacy request", iterations, [&params]() { return legacyRequest(params); });
+    runBenchmark("signed request", iterations, [&params]() { return fastRequest(params); });
+    runBenchmark("order template", iterations, [&]() { return orderTemplate.fill(quantity, price).second.size(); });
+    runBenchmark("sign only", iterations, [&]() { signer.sign(payload, signature); return static_cast<size_t>(signature[0]); });
+    return 0;
+}
@@ -4,11 +4,13 @@
 #include "bnb/marketConnection/BNBFeeder.h"
 #include "bnb/marketConnection/BNBMarketConnectionConfig.h"
 #include "common/Scheduler.h"
-#include "bnb/utils/IBNBRequests.h"
+#include "bnb/utils/BNBRequests/General.h"
+#include "bnb/utils/ExchangeInfo.h"
+#include "bnb/utils/InstrumentRegistry.h"
 #include "common/RecorderMonitor.h"
 
 #include <string>
-#include <unordered_map>
+#include <vector>
 #include <fstream>
 #include <filesystem>
 #include <algorithm>
@@ -28,10 +30,13 @@ private:
     bool startComponents();
     std::vector<std::string> getSubscriptionList(const std::string& symbol);
 
-    void recordData(const std::string& ticker, const std::string& data);
-    void openFileForSymbol(const std::string& ticker);
+    void recordData(InstrumentId instrument, const std::string& data);
+    void openFileForInstrument(InstrumentId instrument);
+    void flushFiles();
     void closeFiles();
 
+    static constexpr size_t MAX_BATCH_SIZE = 4096;
+
     Scheduler scheduler_;
     RecorderMonitor monitor_;
     BNBBroker broker_;
@@ -39,5 +44,9 @@ private:
 
     std::string date_;
     std::string symbol_;
-    std::unordered_map<std::string, std::ofstream> symbol_file_map_;
+    InstrumentRegistry registry_;
+    // Indexed by instrument id, opened on first update.
+    std::vector<std::ofstream> instrument_files_;
+    std::vector<bool> file_dirty_;
+    std::vector<InstrumentId> dirty_files_;
 };
\ No newline at end of file
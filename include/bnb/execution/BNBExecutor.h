@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "common/Clock.h"
+#include "common/LatencyHistogram.h"
+#include "common/logger.hpp"
+#include "fin/Order.h"
+#include "fin/Signal.h"
+#include "bnb/marketConnection/BNBBroker.h"
+#include "bnb/utils/BNBRequests/OrderTemplate.h"
+
+// PIPELINED sends every leg of a signal back-to-back, SEQUENTIAL sends a leg once the
+// previous one is acknowledged and sizes it from what that leg actually filled
+enum class ExecutionMode {
+    PIPELINED,
+    SEQUENTIAL
+};
+
+ExecutionMode parseExecutionMode(const std::string& mode);
+
+struct ExecutionConfig {
+    ExecutionMode mode = ExecutionMode::PIPELINED;
+    // order.test validates the orders without matching them
+    bool testOrders = true;
+};
+
+// Executes the signals of a strategy over the broker, one signal in flight at a time.
+// Responses are tracked on the broker io thread: a leg is acknowledged by its response and
+// filled when the response reports it FILLED (order.place with the FULL response type,
+// the default for MARKET orders). Timings are in ns from the send of each leg.
+class BNBExecutor
+{
+public:
+    BNBExecutor(BNBBroker& broker, const ExecutionConfig& config);
+
+    // Prepares the order templates of a path, signals refer to it by Signal::pathIndex.
+    // Must be called once the broker session is up.
+    size_t addPath(const std::vector<Order>& path);
+
+    // Returns false when the previous signal is still executing
+    bool execute(const Signal& signal);
+    bool isBusy();
+
+    // Responses, timeouts excluded
+    const LatencyHistogram& getAckLatency() const { return ack_latency_; }
+    // Legs completed by a broker timeout (or stop) instead of an exchange response
+    uint64_t getTimeoutCount() const { return timeouts_.load(std::memory_order_relaxed); }
+    const LatencyHistogram& getFillLatency() const { return fill_latency_; }
+    // First send to the last leg completed
+    const LatencyHistogram& getSignalLatency() const { return signal_latency_; }
+    void logStats() const;
+
+private:
+    enum class LegStatus {
+        PENDING,
+        SENT,
+        ACKED,
+        FILLED,
+        REJECTED
+    };
+
+    struct Leg {
+        Order order;
+        LegStatus status = LegStatus::PENDING;
+        uint64_t sendTime = 0;
+        uint64_t ackTime = 0;
+        uint64_t fillTime = 0;
+        // Amount of the resulting asset received, net of commissions paid in it
+        double received = 0;
+    };
+
+    struct Execution {
+        uint64_t sequence = 0;
+        size_t pathIndex = 0;
+        std::string description;
+        std::vector<Leg> legs;
+        size_t completedLegs = 0;
+        bool active = false;
+    };
+
+    // Called with mutex_ held
+    bool sendLeg(size_t leg);
+    void abortFrom(size_t leg);
+    void sizeNextLeg(size_t leg);
+    void complete();
+
+    void onResponse(uint64_t sequence, size_t leg, const nlohmann::json& response);
+
+    BNBBroker& broker_;
+    ExecutionConfig config_;
+    RequestCost orderCost_;
+    std::vector<std::vector<OrderTemplate>> orderTemplates_;
+
+    std::mutex mutex_;
+    Execution execution_;
+    uint64_t sequence_ = 0;
+
+    LatencyHistogram ack_latency_;
+    std::atomic<uint64_t> timeouts_{0};
+    LatencyHistogram fill_latency_;
+    LatencyHistogram signal_latency_;
+};
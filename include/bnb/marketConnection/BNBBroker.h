@@ -2,6 +2,7 @@
 
 #include <nlohmann/json.hpp>
 #include <map>
+#include <memory>
 #include <string>
 #include <thread>
 #include <atomic>
@@ -9,22 +10,34 @@
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 #include <condition_variable>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <limits>
 #include <vector>
-#include <set>
 #include <stdexcept>
-#include <openssl/pem.h>
-#include <openssl/err.h>
-#include <fstream>
-#include <sstream>
 
+#include "common/Clock.h"
+#include "common/ClockOffsetEstimator.h"
+#include "common/ExchangeClock.h"
 #include "common/WebSocketListener.h"
 #include "bnb/utils/BNBRequests/Authentication.h"
+#include "bnb/utils/BNBRequests/General.h"
 #include "common/logger.hpp"
 #include "fin/Order.h"
 #include "bnb/marketConnection/BNBMarketConnectionConfig.h"
+#include "bnb/marketConnection/BNBBrokerSession.h"
+#include "bnb/marketConnection/BNBRateLimiter.h"
 #include "bnb/utils/BNBRequests/RequestsBuilder.h"
 
-class BNBBroker : public WebSocketListener {
+// WS API client over a pool of sessions (connections), ORDERS sessions for order traffic
+// and QUERIES sessions for everything else. Requests go to the least loaded session of
+// their role, or with HEDGED dispatch, hedgeable order requests are written on the two
+// least loaded ORDERS sessions and the first response wins. The pending requests, the
+// rate limiter and the clock estimator are shared by every session.
+class BNBBroker {
 public:
     explicit BNBBroker(const BNBMarketConnectionConfig& config);
     virtual ~BNBBroker();
@@ -32,32 +45,125 @@ public:
     void start();
     void stop();
 
-    std::string sendRequest(const std::string& requestId, const std::string& requestBody);
-    nlohmann::json getResponseForId(const std::string& id);
+    // Gets the response, or an error response on timeout or stop. Runs on an io thread, must not block.
+    using ResponseCallback = std::function<void(nlohmann::json response)>;
 
-protected:
-    void onMessage(websocketpp::connection_hdl hdl, websocketpp::client<websocketpp::config::asio_client>::message_ptr msg) override;
+    // Non-blocking, throws when MAX_PENDING_REQUESTS are already in flight or no session of the
+    // request role is connected, the callback is then never called. Requests go through
+    // the rate limiter: ORDER requests throw when out of budget, the others are queued by
+    // priority until the exchange window rolls over. The timeout runs from this call, queued or not.
+    void sendRequest(const request& req, ResponseCallback callback, RequestCost cost = RequestCost());
+    void sendRequest(const request& req, ResponseCallback callback, std::chrono::milliseconds timeout, RequestCost cost = RequestCost());
+    std::future<nlohmann::json> sendRequest(const request& req, RequestCost cost = RequestCost());
+    size_t getPendingCount();
+    size_t getDeferredCount();
+    const BNBRateLimiter& getRateLimiter() const { return rateLimiter_; }
+    size_t getSessionCount() const { return sessions_.size(); }
+
+    // A request takes the first free slot from id % MAX_PENDING_REQUESTS on, sending only
+    // fails when every slot is in flight
+    static constexpr size_t MAX_PENDING_REQUESTS = 256;
+    // Binance code for "Timeout waiting for response from backend server"
+    static constexpr int TIMEOUT_ERROR_CODE = -1007;
+    // Sessions are tracked in a bit mask
+    static constexpr size_t MAX_SESSIONS = 32;
 
 private:
-    std::string loadPrivateKey(const std::string& keyPath);
+    friend class BNBBrokerSession;
+
+    static constexpr size_t ANY_SESSION = MAX_SESSIONS;
+    // Released outside the io threads, the timer fires later on an inactive slot
+    static constexpr size_t NO_SESSION = MAX_SESSIONS + 1;
+
+    struct PendingRequest {
+        uint64_t id = 0;
+        ResponseCallback callback;
+        wsppclient::timer_ptr timer;
+        // Sessions the request was written on, the timer runs on the first one
+        uint32_t sessions = 0;
+        size_t timerSession = 0;
+        bool active = false;
+        // Last id released from the slot, a hedged copy answered late is dropped quietly
+        uint64_t answeredId = 0;
+    };
+
+    struct DeferredRequest {
+        request req;
+        ResponseCallback callback;
+        // Enqueue time plus the request timeout
+        uint64_t deadlineMs;
+        RequestCost cost;
+        size_t session;
+    };
+
+    // Called by the sessions on their io thread
+    void onSessionMessage(BNBBrokerSession& session, const std::string& payload);
+    void onSessionUp(BNBBrokerSession& session);
+    void onSessionDown(BNBBrokerSession& session);
+
+    void waitSessionsUp();
+    void logIn(BNBBrokerSession& session);
+    // False when the current connection of the session already sent its logon
+    bool logOn(BNBBrokerSession& session, std::function<void(bool)> done);
+    void updateAuthentication();
+    // Exchange clock offset, sampled on the first connected ORDERS session
+    void syncClock();
+    void sampleClock(std::function<void()> done);
+    void scheduleClockSync();
+    void sendRequestOn(size_t session, const request& req, ResponseCallback callback, std::chrono::milliseconds timeout, RequestCost cost);
+    // The caller acquired the budget of one copy, dispatch gives back the budget of every copy it does not write
+    void dispatch(const request& req, ResponseCallback callback, std::chrono::milliseconds timeout, const RequestCost& cost, size_t session);
+    uint32_t pickSessions(const RequestCost& cost);
+    size_t firstUp(const std::vector<size_t>& candidates) const;
+    void refund(const RequestCost& cost, uint32_t sessions);
+    // Called with deferred_mutex_ held
+    void scheduleDrain(uint64_t nowMs);
+    void drainDeferred();
+    void onRateLimited(const nlohmann::json& response, uint64_t nowMs);
+    // session is the io thread releasing the request, ANY_SESSION once the io threads are stopped
+    ResponseCallback release(PendingRequest& pending, size_t session);
+    // Called with pending_mutex_ held
+    PendingRequest* findPending(uint64_t id);
+    bool wasHedged(uint64_t id) const;
+    void onTimeout(uint64_t id);
+    void failPending(const std::string& reason);
+    static nlohmann::json errorResponse(uint64_t id, int status, int code, const std::string& msg);
+    static uint64_t nowMs();
 
     std::string apiKey_;
-    std::string secretKey_;
     std::string uri_;
     bool loginOnConnection_;
     std::string signMethod_;
+    BrokerDispatch dispatch_;
+
+    std::vector<std::unique_ptr<BNBBrokerSession>> sessions_;
+    std::vector<size_t> orderSessions_;
+    std::vector<size_t> querySessions_;
+    std::mutex sessions_mutex_;
+    std::condition_variable sessions_cv_;
 
     //Login utils
-    std::string loginRequestId_;
     std::mutex login_mutex_;
-    std::condition_variable login_cv_;
-    bool is_logged_in_;
+    // Set under sessions_mutex_ once start logged in, reconnected sessions then log on again
+    bool relogIn_ = false;
+
+    std::chrono::milliseconds requestTimeout_;
+    std::mutex pending_mutex_;
+    std::array<PendingRequest, MAX_PENDING_REQUESTS> pending_;
+    size_t pending_count_ = 0;
+
+    BNBRateLimiter rateLimiter_;
+    std::mutex deferred_mutex_;
+    std::array<std::deque<DeferredRequest>, BNBRateLimiter::PRIORITIES> deferred_;
+    size_t deferred_count_ = 0;
+    wsppclient::timer_ptr drain_timer_;
+    static constexpr uint64_t NO_DRAIN = std::numeric_limits<uint64_t>::max();
+    uint64_t drain_at_ms_ = NO_DRAIN;
 
-    std::map<std::string, nlohmann::json> stored_responses_;
-    std::set<std::string> pending_requests_;
-    std::mutex response_mutex_;
-    std::condition_variable response_cv_;
+    static constexpr size_t CLOCK_SYNC_INITIAL_SAMPLES = 4;
+    size_t clockSyncIntervalMs_;
+    ClockOffsetEstimator clockEstimator_;
+    wsppclient::timer_ptr clock_timer_;
 
-    std::thread bws_thread_;
-    std::atomic<bool> brunning_ = true;
+    std::atomic<bool> brunning_ = false;
 };
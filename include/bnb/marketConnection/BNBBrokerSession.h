@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "common/WebSocketListener.h"
+
+class BNBBroker;
+
+// ORDERS sessions carry order traffic only, so an acknowledgement never queues behind a
+// bulk response (exchangeInfo, snapshots) on the same socket. QUERIES sessions carry the rest.
+enum class SessionRole {
+    ORDERS,
+    QUERIES
+};
+
+// One WS API connection of a BNBBroker. Responses are handed to the broker on the
+// session io thread, the broker owns the pending requests of every session. The io loop
+// outlives the connection, a dropped one is reconnected with an exponential backoff.
+class BNBBrokerSession : public WebSocketListener {
+public:
+    BNBBrokerSession(BNBBroker& broker, size_t index, SessionRole role, const std::string& uri,
+                     std::chrono::milliseconds reconnectBackoff, std::chrono::milliseconds maxReconnectBackoff);
+    virtual ~BNBBrokerSession();
+
+    void start();
+    // Never called from the io thread, it joins it
+    void stop();
+
+    size_t getIndex() const { return index_; }
+    SessionRole getRole() const { return role_; }
+    const std::string& getName() const { return name_; }
+    bool isUp() const { return up_.load(std::memory_order_acquire); }
+
+    // Requests written on the session and not answered yet
+    size_t getLoad() const { return load_.load(std::memory_order_relaxed); }
+    void addLoad() { load_.fetch_add(1, std::memory_order_relaxed); sent_.fetch_add(1, std::memory_order_relaxed); }
+    void removeLoad() { load_.fetch_sub(1, std::memory_order_relaxed); }
+    uint64_t getSentCount() const { return sent_.load(std::memory_order_relaxed); }
+
+    // Counts the connections opened, a logon only holds for the connection it was sent on
+    uint64_t getConnection() const { return connection_.load(std::memory_order_acquire); }
+    bool isLoggedIn() const { return loggedIn_.load(std::memory_order_acquire); }
+    void setLoggedIn(bool loggedIn) { loggedIn_.store(loggedIn, std::memory_order_release); }
+    // True for the first caller of a connection, one session.logon is sent per connection
+    bool claimLogOn(uint64_t connection) { return logOnConnection_.exchange(connection, std::memory_order_acq_rel) != connection; }
+
+protected:
+    void onOpen(websocketpp::connection_hdl hdl) override;
+    void onMessage(websocketpp::connection_hdl hdl, wsppclient::message_ptr msg) override;
+    void onClose(websocketpp::connection_hdl hdl) override;
+    void onFail(websocketpp::connection_hdl hdl) override;
+
+private:
+    // On the io thread
+    void onDown();
+    void scheduleReconnect();
+
+    BNBBroker& broker_;
+    const size_t index_;
+    const SessionRole role_;
+    const std::string name_;
+    std::string uri_;
+    std::chrono::milliseconds backoff_;
+    std::chrono::milliseconds max_backoff_;
+    uint32_t attempts_ = 0;
+    wsppclient::timer_ptr reconnect_timer_;
+
+    std::thread ws_thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> up_{false};
+    std::atomic<uint64_t> connection_{0};
+    std::atomic<bool> loggedIn_{false};
+    std::atomic<uint64_t> logOnConnection_{0};
+    std::atomic<size_t> load_{0};
+    std::atomic<uint64_t> sent_{0};
+};
@@ -1,61 +1,197 @@
 #pragma once
 
 #include <string>
-#include <thread>
 #include <atomic>
-#include <set>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
-#include <nlohmann/json.hpp>
 #include <fmt/ranges.h>
 
 #include "bnb/marketData/BookTickerMDFrame.h"
 #include "bnb/marketData/KlineMDFrame.h"
 #include "bnb/marketData/AggTradeMDFrame.h"
+#include "bnb/marketData/DepthMDFrame.h"
+#include "bnb/marketData/MarketDataUpdate.h"
 #include "bnb/marketData/MarketDataFrame.h"
+#include "bnb/marketData/BNBStreamDecoder.h"
+#include "bnb/utils/InstrumentRegistry.h"
 #include "bnb/marketConnection/BNBMarketConnectionConfig.h"
-#include "common/WebSocketListener.h"
+#include "bnb/marketConnection/BNBStreamConnection.h"
+#include "common/SPSCQueue.h"
+#include "common/WaitStrategy.h"
+#include "common/ConflatingMailbox.h"
+#include "common/LatencyHistogram.h"
+#include "common/Clock.h"
+#include "common/ExchangeClock.h"
 
 
+// Spreads the subscribed streams over feederShards websocket connections,
+// each connection pushing into its own SPSC queue drained by the consumer.
+// With redundant legs every shard is subscribed twice (legs A and B) and the
+// first copy of each update wins, duplicates and stale updates are dropped.
+// In CONFLATE delivery mode the queues are replaced by a per-instrument
+// mailbox and getUpdate returns the latest frame of each changed instrument.
+//
+// With wsPersistConnection a supervisor thread replaces lost connections
+// (exponential backoff) and rotates old ones before Binance drops them. The
+// replacement is subscribed before the old connection is torn down, symbols
+// left without any live connection are marked stale and resynchronised with
+// the snapshot provider, if one is set.
+//
+// StreamType is a frame type, or a std::variant of frame types (MarketDataUpdate)
+// to receive several streams per symbol over combined stream connections, in
+// arrival order through the same queues. Arbitration then runs per stream.
 template <typename StreamType>
-class BNBFeeder : public WebSocketListener {
+class BNBFeeder {
 public:
+    // Requests snapshot frames for the given instruments, called from the supervisor thread.
+    // Must not block, done gets the frames once (none on failure) from any thread.
+    using SnapshotCallback = std::function<void(std::vector<StreamType>)>;
+    using SnapshotProvider = std::function<void(const std::vector<InstrumentId>&, SnapshotCallback done)>;
+
     BNBFeeder(const BNBMarketConnectionConfig& config);
     virtual ~BNBFeeder();
 
+    // Must be set before subscribing, frames for symbols outside the registry are dropped.
+    // Sizes the per-instrument state once, connections publish into it as soon as subscribed.
+    void setInstrumentRegistry(const InstrumentRegistry& registry);
+    const InstrumentRegistry& getInstrumentRegistry() const { return *registry_; }
+    void setSnapshotProvider(SnapshotProvider provider) { snapshot_provider_ = std::move(provider); }
     int subscribeToTickers(const std::vector<std::string>& symbols);
     void start();
     void stop();
     StreamType getUpdate();
+    // Replaces the content of out with up to max frames, blocking until one is available.
+    size_t drain(std::vector<StreamType>& out, size_t max);
+    // Same as drain without blocking, returns 0 when nothing is queued.
+    size_t poll(std::vector<StreamType>& out, size_t max);
+    // True while the instrument has no live connection and has not been resynchronised.
+    bool isStale(InstrumentId instrument) const { return stale_ && stale_[instrument].load(std::memory_order_relaxed); }
 
-protected:
-    void onMessage(websocketpp::connection_hdl hdl, websocketpp::client<websocketpp::config::asio_client>::message_ptr msg) override;
-    void onClose(websocketpp::connection_hdl hdl);
-    void onFail(websocketpp::connection_hdl hdl);
+    size_t getShardCount() const { return shards_; }
+    std::vector<uint64_t> getShardUpdateCounts() const;
+    // Updates forwarded first by each leg, and copies dropped as duplicate or stale.
+    std::vector<uint64_t> getLegWinCounts() const;
+    uint64_t getDuplicateCount() const { return duplicates_.load(std::memory_order_relaxed); }
+    // Busy poll loop counters summed over the connections
+    uint64_t getPollIterations() const;
+    uint64_t getPollIdleIterations() const;
+    // Successful and failed connection replacements
+    uint64_t getReconnectCount() const { return reconnects_.load(std::memory_order_relaxed); }
+    uint64_t getFailedReconnectCount() const { return failed_reconnects_.load(std::memory_order_relaxed); }
 
-private:
-    StreamType parseData(const nlohmann::json& json_data);
+    // Exchange event time -> socket receive, socket receive -> decoded, decoded -> dequeued.
+    const LatencyHistogram& getFeedLatency() const { return feed_latency_; }
+    const LatencyHistogram& getParseLatency() const { return parse_latency_; }
+    const LatencyHistogram& getQueueLatency() const { return queue_latency_; }
+    // Connection loss (or rotation start) -> replacement subscribed.
+    const LatencyHistogram& getReconnectLatency() const { return reconnect_latency_; }
     std::string getStreamName();
-    size_t maxStreamsSubs_;
 
-    std::string uri_;
-    std::thread fws_thread_;
-    std::atomic<bool> frunning_;
+private:
+    using Streams = StreamSet<StreamType>;
+    friend class BNBStreamConnection<StreamType>;
+    // Arbitration and conflation key, one per instrument and stream
+    size_t keyOf(const StreamType& dataFrame) const { return Streams::header(dataFrame).instrumentId * Streams::COUNT + Streams::index(dataFrame); }
+    void publish(size_t slot, size_t queue, StreamType&& dataFrame);
+    void onConnectionLost(size_t slot, uint64_t generation);
+    bool arbitrate(size_t slot, const StreamType& dataFrame);
+    bool inOrder(const StreamType& dataFrame);
+    bool accept(const StreamType& dataFrame);
+    bool popResync(StreamType& dataFrame);
+    bool popBatch(std::vector<StreamType>& out, size_t max);
+    void onDequeue(StreamType& dataFrame, uint64_t dequeueTime);
+
+    std::unique_ptr<BNBStreamConnection<StreamType>> makeConnection(size_t slot, size_t queue, uint64_t generation);
+    void supervise();
+    enum class ReplacementState { PENDING, REPLACED, FAILED };
+    void beginReplacement(size_t slot, bool lost);
+    ReplacementState pollReplacement(size_t slot);
+    std::vector<InstrumentId> markStale(size_t slot);
+    void resync(const std::vector<InstrumentId>& instruments);
+    void onSnapshot(size_t requested, std::vector<StreamType> snapshot);
+
+    size_t maxStreamsSubs_;
+    size_t shards_;
+    size_t legs_;
+    DeliveryMode delivery_mode_;
     bool wsPersistConnection_;
+    const InstrumentRegistry* registry_ = nullptr;
+    std::atomic<bool> subscribed_{false};
+    std::atomic<bool> frunning_;
 
-    std::set<int> pending_requests_;
-    int next_request_id_ = 1;
-    std::vector<std::string> subscription_list_;
+    // Connection settings kept to build replacements
+    std::vector<std::string> slot_uris_;
+    std::vector<WebSocketOptions> slot_options_;
+    std::vector<std::string> slot_names_;
 
-    std::queue<StreamType> update_queue_;
-    std::mutex queue_mutex_;
-    std::condition_variable queue_cv_;
-};
+    // One connection per slot, slot = leg * shards + shard. Replaced by the
+    // supervisor, the mutex covers swaps and readers outside the io threads.
+    mutable std::mutex connections_mutex_;
+    std::vector<std::unique_ptr<BNBStreamConnection<StreamType>>> connections_;
+    std::vector<std::vector<std::string>> slot_streams_;
+    std::vector<std::vector<InstrumentId>> slot_instruments_;
+    // Counters of replaced connections
+    std::vector<uint64_t> retired_updates_;
+    uint64_t retired_poll_iterations_ = 0;
+    uint64_t retired_poll_idle_iterations_ = 0;
 
-template <>
-BookTickerMDFrame BNBFeeder<BookTickerMDFrame>::parseData(const nlohmann::json& json_data);
+    // websocket threads -> consumer thread. Two queues per slot so a replacement
+    // connection never shares a producer side with the one it replaces.
+    std::vector<std::unique_ptr<SPSCQueue<StreamType>>> update_queues_;
+    QueueWaiter queue_waiter_;
+    size_t next_queue_ = 0;
+    // CONFLATE mode, created with the instrument registry, null before
+    std::unique_ptr<ConflatingMailbox<StreamType>> mailbox_;
 
-template <>
-KlineMDFrame BNBFeeder<KlineMDFrame>::parseData(const nlohmann::json& json_data);
+    // Sequence arbitration, last sequence forwarded per key. It resolves
+    // redundant legs as well as the overlap of a rotated connection. The producer
+    // side check is racy across queues so the consumer re-checks ordering on pop.
+    std::unique_ptr<std::atomic<uint64_t>[]> last_published_;
+    std::vector<uint64_t> last_delivered_;
+    std::unique_ptr<std::atomic<uint64_t>[]> leg_wins_;
+    std::atomic<uint64_t> duplicates_{0};
 
-template <>
-AggTradeMDFrame BNBFeeder<AggTradeMDFrame>::parseData(const nlohmann::json& json_data);
+    // Reconnect supervisor
+    std::thread supervisor_thread_;
+    std::mutex supervisor_mutex_;
+    std::condition_variable supervisor_cv_;
+    std::vector<bool> lost_;
+    std::vector<uint64_t> generations_;
+    std::vector<uint32_t> attempts_;
+    std::vector<std::chrono::steady_clock::time_point> next_attempts_;
+    std::vector<std::chrono::steady_clock::time_point> connected_at_;
+    std::chrono::milliseconds backoff_;
+    std::chrono::milliseconds max_backoff_;
+    std::chrono::milliseconds reconnect_timeout_;
+    std::chrono::seconds max_connection_age_;
+    // Replacement connection being brought up per slot, supervisor thread only
+    struct Replacement {
+        std::unique_ptr<BNBStreamConnection<StreamType>> connection;
+        uint64_t generation = 0;
+        uint64_t startTime = 0;
+        std::chrono::steady_clock::time_point deadline;
+        bool lost = false;
+        std::vector<InstrumentId> staleInstruments;
+    };
+    std::vector<Replacement> replacements_;
+
+    // Stale marking and snapshot resync, supervisor -> consumer
+    std::unique_ptr<std::atomic<bool>[]> stale_;
+    SnapshotProvider snapshot_provider_;
+    // Snapshots complete on broker threads, pushes are serialised
+    std::mutex resync_mutex_;
+    SPSCQueue<StreamType> resync_queue_;
+    std::atomic<uint64_t> reconnects_{0};
+    std::atomic<uint64_t> failed_reconnects_{0};
+
+    LatencyHistogram feed_latency_;
+    LatencyHistogram parse_latency_;
+    LatencyHistogram queue_latency_;
+    LatencyHistogram reconnect_latency_;
+};
@@ -2,18 +2,61 @@
 #ifndef BNB_MARKET_CONNECTION_CONFIG_H
 #define BNB_MARKET_CONNECTION_CONFIG_H
 
+#include <stdexcept>
 #include <string>
+#include <vector>
+#include "common/WaitStrategy.h"
+#include "common/ConflatingMailbox.h"
+#include "common/WebSocketOptions.h"
+
+// How the broker picks the ORDERS sessions an order request is written on
+enum class BrokerDispatch {
+    LEAST_LOADED,
+    HEDGED
+};
+
+inline BrokerDispatch brokerDispatchFromString(const std::string& name) {
+    if (name == "LEAST_LOADED") return BrokerDispatch::LEAST_LOADED;
+    if (name == "HEDGED") return BrokerDispatch::HEDGED;
+    throw std::runtime_error("Unknown broker dispatch : <" + name + ">.");
+}
 
 struct BNBMarketConnectionConfig {
     std::string streamsWsEndpoint;
+    std::string streamsWsEndpointB;
     std::string apiWsEndpoint;
     std::string apiKey;
     std::string apiSecret;
     std::string privateKeyPath;
     size_t maxStreamsSubs;
     bool wsPersistConnection;
+    // Feeder reconnect supervisor, used with wsPersistConnection
+    size_t wsReconnectBackoffMs;
+    size_t wsReconnectMaxBackoffMs;
+    size_t wsReconnectTimeoutMs;
+    size_t wsMaxConnectionAgeS;
     bool loginOnConnection;
+    // Broker requests without a response by then complete with a timeout error
+    size_t apiRequestTimeoutMs;
+    // Request weight per minute left to orders by queries, and to queries by bulk requests
+    uint32_t rateLimitOrderReserveWeight;
+    uint32_t rateLimitBulkReserveWeight;
+    // Period of the exchange clock offset samples, 0 disables the estimator
+    size_t clockSyncIntervalMs;
     std::string signMethod;
+    size_t feederQueueCapacity;
+    WaitStrategy feederWaitStrategy;
+    size_t feederShards;
+    bool feederRedundantLegs;
+    DeliveryMode feederDeliveryMode;
+    WebSocketOptions wsOptions;
+    // Busy poll cores, assigned in order to the feeder connections
+    std::vector<int> feederBusyPollCpus;
+    int brokerBusyPollCpu;
+    // WS API connections of the broker, queries share the ORDERS sessions when there is no QUERIES one
+    size_t brokerOrderSessions;
+    size_t brokerQuerySessions;
+    BrokerDispatch brokerDispatch;
 };
 
 BNBMarketConnectionConfig loadConfig(const std::string& configFile);
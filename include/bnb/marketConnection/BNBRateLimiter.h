@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <nlohmann/json.hpp>
+
+// ORDER traffic (orders and session requests) is never queued and may use the whole budget,
+// QUERY and BULK requests keep a reserve of request weight untouched for it
+enum class RequestPriority {
+    ORDER,
+    QUERY,
+    BULK
+};
+
+struct RequestCost {
+    uint32_t weight = 1;
+    uint32_t orders = 0;
+    RequestPriority priority = RequestPriority::QUERY;
+    // May be written on two sessions at once, only requests the exchange executes harmlessly twice
+    bool hedgeable = false;
+};
+
+// Request weights of the WS API methods we use
+namespace RequestCosts {
+    inline constexpr RequestCost ORDER{1, 1, RequestPriority::ORDER};
+    inline constexpr RequestCost ORDER_TEST{1, 0, RequestPriority::ORDER, true};
+    inline constexpr RequestCost ORDER_TEST_COMMISSION{20, 0, RequestPriority::ORDER, true};
+    inline constexpr RequestCost SESSION{2, 0, RequestPriority::ORDER};
+    inline constexpr RequestCost SERVER_TIME{1, 0, RequestPriority::QUERY};
+    inline constexpr RequestCost ACCOUNT_INFORMATION{20, 0, RequestPriority::QUERY};
+    inline constexpr RequestCost BOOK_TICKERS{4, 0, RequestPriority::QUERY};
+    // depth at the default limit of 1000 levels
+    inline constexpr RequestCost ORDER_BOOK{50, 0, RequestPriority::QUERY};
+    inline constexpr RequestCost EXCHANGE_INFORMATION{20, 0, RequestPriority::BULK};
+}
+
+// Budget of one exchange rate limit. Binance counts usage per fixed window aligned on the
+// interval, so the bucket refills completely when the window rolls over. The window index
+// and the amount used are packed in one atomic and updated with CAS.
+class RateLimitBucket {
+public:
+    RateLimitBucket(uint32_t limit, uint64_t intervalMs) : limit_(limit), intervalMs_(intervalMs) {}
+
+    // Takes amount unless less than reserve would be left in the current window
+    bool tryAcquire(uint32_t amount, uint32_t reserve, uint64_t nowMs);
+    void release(uint32_t amount, uint64_t nowMs);
+    // Usage reported by the exchange, it does not know our requests still in flight so the
+    // highest of the two counts is kept
+    void correct(uint32_t count, uint32_t limit, uint64_t nowMs);
+
+    uint32_t used(uint64_t nowMs) const;
+    uint32_t limit() const { return limit_.load(std::memory_order_relaxed); }
+    uint64_t intervalMs() const { return intervalMs_; }
+    uint64_t nextWindowMs(uint64_t nowMs) const { return (nowMs / intervalMs_ + 1) * intervalMs_; }
+
+private:
+    static uint64_t pack(uint32_t window, uint32_t used) { return (static_cast<uint64_t>(window) << 32) | used; }
+    static uint32_t windowOf(uint64_t state) { return static_cast<uint32_t>(state >> 32); }
+    static uint32_t usedOf(uint64_t state) { return static_cast<uint32_t>(state); }
+    uint32_t currentWindow(uint64_t nowMs) const { return static_cast<uint32_t>(nowMs / intervalMs_); }
+
+    std::atomic<uint64_t> state_{0};
+    std::atomic<uint32_t> limit_;
+    const uint64_t intervalMs_;
+};
+
+// Client side model of the REQUEST_WEIGHT, ORDERS per 10s and ORDERS per day limits of the
+// WS API, starting from the documented limits and corrected from the rateLimits of responses.
+// Lock free, any thread may acquire or update.
+class BNBRateLimiter {
+public:
+    static constexpr size_t PRIORITIES = 3;
+
+    BNBRateLimiter(uint32_t orderReserveWeight, uint32_t bulkReserveWeight);
+
+    // All the buckets or none
+    bool tryAcquire(const RequestCost& cost, uint64_t nowMs);
+    // Gives back the budget of a request acquired and not sent, a no-op once the window rolled over
+    void release(const RequestCost& cost, uint64_t nowMs);
+    void update(const nlohmann::json& rateLimits, uint64_t nowMs);
+    // After a 429/418 nothing may be sent before untilMs
+    void blockUntil(uint64_t untilMs);
+    // When the weight used in the current window is given back
+    uint64_t nextRefillMs(uint64_t nowMs) const;
+    std::string describe(uint64_t nowMs) const;
+
+private:
+    uint32_t weightReserve(RequestPriority priority) const;
+    RateLimitBucket* find(const std::string& type, const std::string& interval, uint64_t intervalNum);
+
+    RateLimitBucket requestWeight_{6000, 60 * 1000};
+    RateLimitBucket orders10s_{100, 10 * 1000};
+    RateLimitBucket ordersDay_{200000, 24 * 60 * 60 * 1000};
+    std::atomic<uint64_t> blockedUntilMs_{0};
+    uint32_t orderReserveWeight_;
+    uint32_t bulkReserveWeight_;
+};
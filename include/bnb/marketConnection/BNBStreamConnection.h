@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "common/WebSocketListener.h"
+
+template <typename StreamType>
+class BNBFeeder;
+
+// One websocket connection of a BNBFeeder, subscribed to a shard of the
+// feeder's streams. Frames are decoded on the connection io thread and
+// handed to the owning feeder under the connection's slot and queue.
+// Subscriptions are sent from onOpen, so nothing blocks on a socket that
+// never opens; a closed or failed connection only reports itself to the
+// feeder, which replaces it from its reconnect supervisor.
+template <typename StreamType>
+class BNBStreamConnection : public WebSocketListener {
+public:
+    BNBStreamConnection(BNBFeeder<StreamType>& feeder, size_t slot, size_t queue, uint64_t generation, const std::string& name, const std::string& uri, size_t maxStreamsSubs);
+    virtual ~BNBStreamConnection();
+
+    void start();
+    void stop();
+    void subscribe(const std::vector<std::string>& streams);
+
+    size_t getSlot() const { return slot_; }
+    size_t getQueue() const { return queue_; }
+    uint64_t getGeneration() const { return generation_; }
+    const std::string& getName() const { return name_; }
+    uint64_t getUpdatesCount() const { return updatesCount_.load(std::memory_order_relaxed); }
+    // Every SUBSCRIBE request of the current streams was acknowledged
+    bool isSubscribed() const { return subscribed_.load(std::memory_order_acquire); }
+    bool isDown() const { return down_.load(std::memory_order_acquire); }
+
+protected:
+    void onOpen(websocketpp::connection_hdl hdl) override;
+    void onMessage(websocketpp::connection_hdl hdl, wsppclient::message_ptr msg) override;
+    void onClose(websocketpp::connection_hdl hdl) override;
+    void onFail(websocketpp::connection_hdl hdl) override;
+
+private:
+    void sendSubscriptions();
+    void onControlMessage(std::string_view payload);
+    void stamp(StreamType& dataFrame, uint64_t receiveTime);
+    void onDown();
+
+    BNBFeeder<StreamType>& feeder_;
+    const size_t slot_;
+    const size_t queue_;
+    const uint64_t generation_;
+    const std::string name_;
+    std::string uri_;
+    size_t maxStreamsSubs_;
+
+    std::thread ws_thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> subscribed_{false};
+    std::atomic<bool> down_{false};
+    std::atomic<uint64_t> updatesCount_{0};
+
+    // Shared between the io thread and the subscribing thread
+    std::mutex subscription_mutex_;
+    bool open_ = false;
+    std::set<int> pending_requests_;
+    int next_request_id_ = 1;
+    std::vector<std::string> streams_;
+};
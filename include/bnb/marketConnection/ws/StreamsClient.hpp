@@ -21,7 +21,7 @@ namespace WS
             RequestId setProperty(const std::string& property, const std::string& value);
         
         protected:
-            void onMessage(websocketpp::connection_hdl hdl, websocketpp::client<websocketpp::config::asio_client>::message_ptr msg) override;
+            void onMessage(websocketpp::connection_hdl hdl, wsppclient::message_ptr msg) override;
             void onClose(websocketpp::connection_hdl hdl);
             void onFail(websocketpp::connection_hdl hdl);
 
@@ -3,22 +3,28 @@
 #define AGGTRADE_MDFRAME_H
 
 #include "MarketDataFrame.h"
+#include "fin/Decimal.h"
 
 class AggTradeMDFrame : public MarketDataFrame {
 public:
-    std::string symbol;
-    std::string price;
-    std::string quantity;
-    std::string tradeId;
-    // Add other AggTrade attributes as needed
-    std::string to_str() const override
+    Price price;
+    Qty quantity;
+    uint64_t tradeId = 0;       // aggregate trade id
+    uint64_t firstTradeId = 0;
+    uint64_t lastTradeId = 0;
+    bool isBuyerMaker = false;  // true when the aggressor sold
+
+    std::string to_str(const std::string& symbol) const
     {
-        return symbol+ ";" + std::to_string(timestamp.time_since_epoch().count())+ ";" + price + ";" + quantity + ";" + tradeId;
+        return symbol+ ";" + std::to_string(receiveTime)+ ";" + price.to_str() + ";" + quantity.to_str() + ";" + std::to_string(tradeId)
+            + ";" + std::to_string(firstTradeId) + ";" + std::to_string(lastTradeId) + ";" + std::to_string(transactionTime) + ";" + (isBuyerMaker ? "1" : "0");
     }
     static std::string getHeader()
     {
-        return "symbol;timestamp;price;quantity;tradeId";
+        return "symbol;timestamp;price;quantity;tradeId;firstTradeId;lastTradeId;tradeTime;isBuyerMaker";
     } 
 };
 
+static_assert(std::is_trivially_copyable_v<AggTradeMDFrame>);
+
 #endif // AGGTRADE_MDFRAME_H
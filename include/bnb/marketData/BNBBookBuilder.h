@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "bnb/marketConnection/BNBBroker.h"
+#include "bnb/marketConnection/BNBFeeder.h"
+#include "bnb/marketData/BNBOrderBook.h"
+#include "bnb/marketData/DepthMDFrame.h"
+#include "bnb/utils/InstrumentRegistry.h"
+#include "fin/Symbol.h"
+
+// Keeps the L2 books of a set of instruments from their diff depth streams. A book
+// is bootstrapped with a depth snapshot over the broker once its first diffs are
+// buffered, and again after a sequence gap or when the feeder lost its stream.
+// Books are updated and read by the thread calling poll, snapshots complete on the
+// broker io threads and are handed over under a mutex.
+class BNBBookBuilder {
+public:
+    BNBBookBuilder(const BNBMarketConnectionConfig& config, BNBBroker& broker, size_t ladderTicks);
+    ~BNBBookBuilder();
+
+    // Symbols must belong to the registry, it has to outlive the builder
+    void subscribe(const InstrumentRegistry& registry, const std::vector<Symbol>& symbols);
+    void start();
+    void stop();
+
+    // Applies the queued diffs and completed snapshots, never blocks. Returns the number of diffs read.
+    size_t poll();
+
+    // Null when the instrument has no book or the book is not synced
+    const BNBOrderBook* getBook(InstrumentId instrument) const;
+    uint64_t getSnapshotCount() const { return snapshots_; }
+
+private:
+    struct Snapshot {
+        InstrumentId instrument;
+        nlohmann::json response;
+    };
+
+    struct BookState {
+        std::unique_ptr<BNBOrderBook> book;
+        // Snapshot in flight
+        bool requested = false;
+        // In waiting_, a snapshot is requested once diffs are buffered and retryAt is past
+        bool waiting = false;
+        std::chrono::steady_clock::time_point retryAt;
+    };
+
+    void requestSnapshot(InstrumentId instrument);
+    void applySnapshot(const Snapshot& snapshot);
+    void waitSnapshot(InstrumentId instrument, std::chrono::milliseconds delay);
+
+    // Delay before asking again for the snapshot of a book that could not be synced
+    static constexpr std::chrono::milliseconds SNAPSHOT_RETRY_DELAY{1000};
+    static constexpr size_t MAX_BATCH_SIZE = 1024;
+
+    BNBBroker& broker_;
+    BNBFeeder<DepthMDFrame> feeder_;
+    size_t ladderTicks_;
+    const InstrumentRegistry* registry_ = nullptr;
+    // Indexed by instrument id, no book for the instruments not subscribed
+    std::vector<BookState> books_;
+    std::vector<InstrumentId> waiting_;
+    std::vector<DepthMDFrame> batch_;
+
+    // Broker io threads and feeder supervisor -> poll
+    std::mutex handover_mutex_;
+    std::vector<Snapshot> completed_;
+    std::vector<InstrumentId> lost_;
+    uint64_t snapshots_ = 0;
+};
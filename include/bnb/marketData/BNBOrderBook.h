@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "bnb/marketData/DepthMDFrame.h"
+#include "bnb/utils/InstrumentRegistry.h"
+#include "fin/PriceLadder.h"
+
+// Local L2 book of one instrument, diff depth frames applied on top of an
+// orderBook snapshot with the Binance update id sequencing:
+//  - diffs received before the snapshot are buffered,
+//  - diffs with finalUpdateId <= snapshot lastUpdateId are discarded,
+//  - every applied diff must have firstUpdateId <= previous finalUpdateId + 1,
+//    otherwise updates were missed and the book waits for a new snapshot.
+class BNBOrderBook {
+public:
+    BNBOrderBook(InstrumentId instrument, Price tickSize, size_t ladderTicks);
+
+    // Returns false when a gap was detected, the caller must then request a new snapshot.
+    bool onDepth(const DepthMDFrame& frame);
+    // Result of the depth request: {"lastUpdateId":..,"bids":[["price","qty"],..],"asks":[..]}.
+    // Returns false if the buffered diffs do not connect to it (snapshot too old).
+    bool applySnapshot(const nlohmann::json& snapshot);
+    // Drops the book when diffs may have been missed without a visible gap (feed lost),
+    // diffs are buffered again until the next snapshot.
+    void invalidate();
+
+    InstrumentId getInstrument() const { return instrument_; }
+    bool isSynced() const { return synced_; }
+    uint64_t getLastUpdateId() const { return last_update_id_; }
+    uint64_t getGapCount() const { return gaps_; }
+    // Diffs buffered while waiting for a snapshot
+    size_t getPendingCount() const { return pending_.size(); }
+
+    const PriceLadder& bids() const { return bids_; }
+    const PriceLadder& asks() const { return asks_; }
+
+private:
+    bool apply(const DepthMDFrame& frame);
+    void applyLevels(const DepthMDFrame& frame);
+    void reset(const DepthMDFrame& frame);
+
+    // Bound on diffs kept while waiting for a snapshot
+    static constexpr size_t MAX_PENDING_FRAMES = 4096;
+
+    InstrumentId instrument_;
+    PriceLadder bids_;
+    PriceLadder asks_;
+    bool synced_ = false;
+    uint64_t last_update_id_ = 0;
+    // Chunk expected next for the event last_update_id_, 0 once it is complete
+    uint16_t next_chunk_ = 0;
+    std::vector<DepthMDFrame> pending_;
+    uint64_t gaps_ = 0;
+};
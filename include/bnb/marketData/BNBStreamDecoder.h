@@ -0,0 +1,79 @@
+// BNBStreamDecoder.h
+#ifndef BNB_STREAM_DECODER_H
+#define BNB_STREAM_DECODER_H
+
+#include <string_view>
+#include <cstdint>
+#include <variant>
+
+#include "bnb/marketData/BookTickerMDFrame.h"
+#include "bnb/marketData/KlineMDFrame.h"
+#include "bnb/marketData/AggTradeMDFrame.h"
+#include "bnb/marketData/DepthMDFrame.h"
+#include "bnb/marketData/MarketDataUpdate.h"
+#include "bnb/utils/InstrumentRegistry.h"
+
+enum class DecodeResult {
+    FRAME,      // payload decoded into the frame
+    CONTROL,    // subscription response, error or anything not market data
+    MALFORMED,  // looked like market data but could not be decoded
+    UNKNOWN_INSTRUMENT  // decoded, but the symbol is not in the instrument registry
+};
+
+// Minimal in-place JSON cursor for the flat objects Binance pushes on streams.
+// Never allocates, string values are returned as views into the payload.
+class JsonCursor {
+public:
+    explicit JsonCursor(std::string_view payload) : cur_(payload.data()), end_(payload.data() + payload.size()) {}
+
+    bool enterObject();
+    bool leaveObject();
+    // Reads the next key of the current object, false at the closing brace.
+    bool nextKey(std::string_view& key);
+    bool enterArray();
+    bool leaveArray();
+    // Moves to the next element of the current array, false at the closing bracket.
+    bool nextElement();
+
+    bool readString(std::string_view& value);
+    bool readUInt(uint64_t& value);
+    bool readInt(int64_t& value);
+    bool readBool(bool& value);
+    bool skipValue();
+    // Skips the next value and returns its raw text.
+    bool readRaw(std::string_view& value);
+    const char* position() const { return cur_; }
+
+private:
+    void skipWhitespace();
+    bool expect(char c);
+
+    const char* cur_;
+    const char* end_;
+};
+
+// Schema-specific decoders for the raw stream payloads.
+class BNBStreamDecoder {
+public:
+    static DecodeResult decode(std::string_view payload, const InstrumentRegistry& registry, BookTickerMDFrame& frame);
+    static DecodeResult decode(std::string_view payload, const InstrumentRegistry& registry, KlineMDFrame& frame);
+    static DecodeResult decode(std::string_view payload, const InstrumentRegistry& registry, AggTradeMDFrame& frame);
+    // Decodes the levels of frame.chunk, set by the caller, and flags the last chunk.
+    static DecodeResult decode(std::string_view payload, const InstrumentRegistry& registry, DepthMDFrame& frame);
+    // Decodes the chunk of a frame returned by nextChunk, from where the previous chunk
+    // stopped, so an event is read once whatever its number of chunks.
+    static DecodeResult decodeNextChunk(std::string_view payload, DepthMDFrame& frame);
+    template <typename Frame>
+    static DecodeResult decodeNextChunk(std::string_view, Frame&) { return DecodeResult::MALFORMED; }
+    template <typename... Frames>
+    static DecodeResult decodeNextChunk(std::string_view payload, std::variant<Frames...>& frame) {
+        return std::visit([payload](auto& alternative) { return decodeNextChunk(payload, alternative); }, frame);
+    }
+    // Combined stream envelope {"stream":"<symbol>@<name>","data":{...}}, the
+    // alternative is picked from the stream name. A depth alternative already
+    // held by the frame keeps its chunk index, its resume point is relative to the envelope.
+    static DecodeResult decode(std::string_view payload, const InstrumentRegistry& registry, QuoteTradeUpdate& frame);
+    static DecodeResult decode(std::string_view payload, const InstrumentRegistry& registry, MarketDataUpdate& frame);
+};
+
+#endif // BNB_STREAM_DECODER_H
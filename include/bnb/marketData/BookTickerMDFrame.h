@@ -3,18 +3,19 @@
 #define BOOKTICKER_MDFRAME_H
 
 #include "MarketDataFrame.h"
+#include "fin/Decimal.h"
 
 class BookTickerMDFrame : public MarketDataFrame {
 public:
-    std::string symbol;
-    double bestBidPrice;
-    double bestBidQty;
-    double bestAskPrice;
-    double bestAskQty;
+    uint64_t updateId = 0;
+    Price bestBidPrice;
+    Qty bestBidQty;
+    Price bestAskPrice;
+    Qty bestAskQty;
 
-    std::string to_str() const override
+    std::string to_str(const std::string& symbol) const
     {
-        return symbol+ ";" + std::to_string(timestamp.time_since_epoch().count())+ ";" + std::to_string(bestBidPrice) + ";" + std::to_string(bestBidQty) + ";" + std::to_string(bestAskPrice) + ";" + std::to_string(bestAskQty);
+        return symbol+ ";" + std::to_string(receiveTime)+ ";" + bestBidPrice.to_str() + ";" + bestBidQty.to_str() + ";" + bestAskPrice.to_str() + ";" + bestAskQty.to_str();
     }
     static std::string getHeader()
     {
@@ -22,4 +23,6 @@ public:
     }  
 };
 
+static_assert(std::is_trivially_copyable_v<BookTickerMDFrame>);
+
 #endif // BOOKTICKER_MDFRAME_H
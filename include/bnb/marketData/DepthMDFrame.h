@@ -0,0 +1,57 @@
+// DepthMDFrame.h
+#ifndef DEPTH_MDFRAME_H
+#define DEPTH_MDFRAME_H
+
+#include "MarketDataFrame.h"
+#include "fin/Decimal.h"
+
+struct DepthLevel {
+    Price price;
+    Qty qty;  // 0 removes the level
+};
+
+// One diff depth event (<symbol>@depth@100ms). The level storage is fixed so
+// the frame stays trivially copyable, larger events are split in chunks that
+// share the update ids and must be applied in order.
+class DepthMDFrame : public MarketDataFrame {
+public:
+    static constexpr size_t MAX_LEVELS = 32;
+    static constexpr size_t MAX_CHUNKS = 256;
+
+    uint64_t firstUpdateId = 0;  // U
+    uint64_t finalUpdateId = 0;  // u
+    uint16_t chunk = 0;
+    bool lastChunk = true;
+    uint16_t bidCount = 0;
+    uint16_t askCount = 0;
+    // Bids fill the array from the front, asks from the back
+    DepthLevel levels[MAX_LEVELS];
+    // Set by the decoder, the next chunk resumes from there rather than from the payload start
+    uint16_t levelCount = 0;  // levels of the whole event
+    bool nextChunkBid = true;
+    uint32_t nextChunkOffset = 0;
+
+    const DepthLevel& bid(size_t i) const { return levels[i]; }
+    const DepthLevel& ask(size_t i) const { return levels[MAX_LEVELS - 1 - i]; }
+
+    std::string to_str(const std::string& symbol) const
+    {
+        std::string out = symbol + ";" + std::to_string(receiveTime) + ";" + std::to_string(firstUpdateId) + ";" + std::to_string(finalUpdateId) + ";";
+        for (size_t i = 0; i < bidCount; ++i) {
+            out += (i ? "," : "") + bid(i).price.to_str() + "@" + bid(i).qty.to_str();
+        }
+        out += ";";
+        for (size_t i = 0; i < askCount; ++i) {
+            out += (i ? "," : "") + ask(i).price.to_str() + "@" + ask(i).qty.to_str();
+        }
+        return out;
+    }
+    static std::string getHeader()
+    {
+        return "symbol;timestamp;firstUpdateId;finalUpdateId;bids;asks";
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<DepthMDFrame>);
+
+#endif // DEPTH_MDFRAME_H
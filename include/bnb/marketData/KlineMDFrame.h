@@ -2,26 +2,54 @@
 #ifndef KLINE_MDFRAME_H
 #define KLINE_MDFRAME_H
 
+#include <charconv>
 #include "MarketDataFrame.h"
+#include "fin/Decimal.h"
 
 class KlineMDFrame : public MarketDataFrame {
 public:
-    std::string symbol;
-    std::string open;
-    std::string high;
-    std::string low;
-    std::string close;
-    std::string volume;
-    // Add other Kline attributes as needed
-    std::string to_str() const override
+    static constexpr size_t MAX_INTERVAL_CHARS = 3;
+
+    uint64_t openTime = 0;      // kline start time in ms
+    uint64_t closeTime = 0;     // kline close time in ms
+    char interval[MAX_INTERVAL_CHARS + 1] = {};  // "1s", "1m", "15m", "1M"...
+    Price open;
+    Price high;
+    Price low;
+    Price close;
+    // Volumes of daily or weekly klines exceed the Qty range (about 9.2e10) on
+    // low priced assets, they are kept as doubles
+    double volume = 0;          // base asset volume
+    double quoteVolume = 0;
+    double takerBuyVolume = 0;  // taker buy base asset volume
+    double takerBuyQuoteVolume = 0;
+    int64_t firstTradeId = -1;  // -1 when the kline has no trade
+    int64_t lastTradeId = -1;
+    uint64_t tradeCount = 0;
+    bool isClosed = false;
+
+    std::string to_str(const std::string& symbol) const
     {
-        return symbol+ ";" + std::to_string(timestamp.time_since_epoch().count()) + ";" + open + ";" + high + ";" + low + ";" + close + ";" + volume;
+        return symbol+ ";" + std::to_string(receiveTime) + ";" + open.to_str() + ";" + high.to_str() + ";" + low.to_str() + ";" + close.to_str() + ";" + volumeToStr(volume)
+            + ";" + std::to_string(openTime) + ";" + std::to_string(closeTime) + ";" + interval + ";" + volumeToStr(quoteVolume) + ";" + volumeToStr(takerBuyVolume)
+            + ";" + volumeToStr(takerBuyQuoteVolume) + ";" + std::to_string(firstTradeId) + ";" + std::to_string(lastTradeId) + ";" + std::to_string(tradeCount)
+            + ";" + (isClosed ? "1" : "0");
     }
     static std::string getHeader()
     {
-        return "symbol;timestamp;open;high;low;close;volume";
+        return "symbol;timestamp;open;high;low;close;volume;openTime;closeTime;interval;quoteVolume;takerBuyVolume;takerBuyQuoteVolume;firstTradeId;lastTradeId;tradeCount;isClosed";
     }  
 
+private:
+    // Shortest text that reads back to the same value, "1234.5" rather than "1234.500000"
+    static std::string volumeToStr(double value)
+    {
+        char buffer[32];
+        return std::string(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+    }
+
 };
 
+static_assert(std::is_trivially_copyable_v<KlineMDFrame>);
+
 #endif // KLINE_MDFRAME_H
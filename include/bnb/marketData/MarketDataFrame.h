@@ -3,15 +3,21 @@
 #define MARKETDATAFRAME_H
 
 #include <string>
-#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include "bnb/utils/InstrumentRegistry.h"
 
+// Common header of every market data frame. Frames are plain trivially
+// copyable structs so they can be moved through queues with a memcpy.
 class MarketDataFrame {
 public:
-    MarketDataFrame() : timestamp(std::chrono::system_clock::now()) {}
-    virtual ~MarketDataFrame() = default;
-    virtual std::string to_str() const = 0;  // Pure virtual method to be implemented by subtypes
-    static std::string getHeader();
-    std::chrono::system_clock::time_point timestamp;
+    InstrumentId instrumentId = INVALID_INSTRUMENT_ID;
+    uint64_t exchangeTime = 0;     // exchange event time in ms since epoch, 0 if the stream has none
+    uint64_t transactionTime = 0;  // exchange trade/transaction time in ms since epoch, 0 if the stream has none
+    // Local timestamps in ns since epoch, taken with Clock::now()
+    uint64_t receiveTime = 0;      // payload handed over by the socket
+    uint64_t parseTime = 0;        // frame decoded
+    uint64_t dequeueTime = 0;      // frame taken by the consumer
 };
 
 #endif // MARKETDATAFRAME_H
@@ -0,0 +1,88 @@
+// MarketDataUpdate.h
+#ifndef MARKETDATA_UPDATE_H
+#define MARKETDATA_UPDATE_H
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "bnb/marketData/BookTickerMDFrame.h"
+#include "bnb/marketData/KlineMDFrame.h"
+#include "bnb/marketData/AggTradeMDFrame.h"
+#include "bnb/marketData/DepthMDFrame.h"
+
+// Several streams of the same symbols multiplexed on one combined stream
+// connection and delivered through one queue, in arrival order.
+using QuoteTradeUpdate = std::variant<BookTickerMDFrame, AggTradeMDFrame>;
+using MarketDataUpdate = std::variant<BookTickerMDFrame, AggTradeMDFrame, DepthMDFrame>;
+
+static_assert(std::is_trivially_copyable_v<QuoteTradeUpdate>);
+static_assert(std::is_trivially_copyable_v<MarketDataUpdate>);
+
+// Stream name of each frame type, subscribed as "<symbol>@<NAME>"
+template <typename Frame>
+struct StreamTraits;
+
+template <>
+struct StreamTraits<BookTickerMDFrame> { static constexpr std::string_view NAME = "bookTicker"; };
+
+template <>
+struct StreamTraits<KlineMDFrame> { static constexpr std::string_view NAME = "kline_1m"; };
+
+template <>
+struct StreamTraits<AggTradeMDFrame> { static constexpr std::string_view NAME = "aggTrade"; };
+
+template <>
+struct StreamTraits<DepthMDFrame> { static constexpr std::string_view NAME = "depth@100ms"; };
+
+// Uniform access to single frames and variants of frames, so the feeder code is shared.
+template <typename StreamType>
+struct StreamSet {
+    static constexpr size_t COUNT = 1;
+    static constexpr bool HAS_DEPTH = std::is_same_v<StreamType, DepthMDFrame>;
+    static std::vector<std::string_view> names() { return {StreamTraits<StreamType>::NAME}; }
+    static size_t index(const StreamType&) { return 0; }
+    static MarketDataFrame& header(StreamType& frame) { return frame; }
+    static const MarketDataFrame& header(const StreamType& frame) { return frame; }
+};
+
+template <typename... Frames>
+struct StreamSet<std::variant<Frames...>> {
+    static constexpr size_t COUNT = sizeof...(Frames);
+    static constexpr bool HAS_DEPTH = (std::is_same_v<Frames, DepthMDFrame> || ...);
+    static std::vector<std::string_view> names() { return {StreamTraits<Frames>::NAME...}; }
+    static size_t index(const std::variant<Frames...>& frame) { return frame.index(); }
+    static MarketDataFrame& header(std::variant<Frames...>& frame) {
+        return std::visit([](auto& alternative) -> MarketDataFrame& { return alternative; }, frame);
+    }
+    static const MarketDataFrame& header(const std::variant<Frames...>& frame) {
+        return std::visit([](const auto& alternative) -> const MarketDataFrame& { return alternative; }, frame);
+    }
+};
+
+// Depth events too large for one frame are split, each following chunk keeps the
+// header and resume point of the previous one (see BNBStreamDecoder::decodeNextChunk).
+inline bool isLastChunk(const MarketDataFrame&) { return true; }
+inline bool isLastChunk(const DepthMDFrame& frame) { return frame.lastChunk; }
+template <typename... Frames>
+bool isLastChunk(const std::variant<Frames...>& frame) {
+    return std::visit([](const auto& alternative) { return isLastChunk(alternative); }, frame);
+}
+
+template <typename Frame>
+Frame nextChunk(const Frame&) { return Frame{}; }
+inline DepthMDFrame nextChunk(const DepthMDFrame& frame) {
+    DepthMDFrame next = frame;
+    next.chunk = frame.chunk + 1;
+    next.bidCount = 0;
+    next.askCount = 0;
+    return next;
+}
+template <typename... Frames>
+std::variant<Frames...> nextChunk(const std::variant<Frames...>& frame) {
+    return std::visit([](const auto& alternative) -> std::variant<Frames...> { return nextChunk(alternative); }, frame);
+}
+
+#endif // MARKETDATA_UPDATE_H
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <sodium.h>
+
+// Ed25519 request signer, the key is read once from a PEM (PKCS#8) private key file.
+class Ed25519Signer
+{
+public:
+    // Base64 of the 64 bytes signature, padding included
+    static constexpr size_t SIGNATURE_CHARS = 88;
+
+    explicit Ed25519Signer(const std::string& privateKeyPath);
+    ~Ed25519Signer();
+    Ed25519Signer(const Ed25519Signer&) = delete;
+    Ed25519Signer& operator=(const Ed25519Signer&) = delete;
+
+    // Writes SIGNATURE_CHARS base64 chars, thread safe
+    void sign(std::string_view payload, char* signature) const;
+
+private:
+    unsigned char secretKey_[crypto_sign_SECRETKEYBYTES];
+};
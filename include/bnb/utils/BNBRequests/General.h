@@ -1,3 +1,4 @@
+#pragma once
 #include "bnb/utils/BNBRequests/RequestsBuilder.h"
 
 namespace BNBRequests
@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <openssl/evp.h>
+
+// HMAC-SHA256 keyed once: the inner and outer pad blocks are hashed at construction,
+// signing resumes from copies of those two states instead of re-deriving the pads.
+class HmacSigner
+{
+public:
+    static constexpr size_t DIGEST_BYTES = 32;
+    static constexpr size_t SIGNATURE_CHARS = 2 * DIGEST_BYTES;
+
+    explicit HmacSigner(std::string_view key);
+    ~HmacSigner();
+    HmacSigner(const HmacSigner&) = delete;
+    HmacSigner& operator=(const HmacSigner&) = delete;
+
+    // Writes SIGNATURE_CHARS lowercase hex chars, thread safe
+    void sign(std::string_view payload, char* signature) const;
+
+private:
+    EVP_MD_CTX* inner_;
+    EVP_MD_CTX* outer_;
+};
@@ -1,3 +1,4 @@
+#pragma once
 #include "bnb/utils/BNBRequests/RequestsBuilder.h"
 
 namespace BNBRequests
@@ -5,7 +6,7 @@ namespace BNBRequests
     class MarketData
     {
     public:
-        static request orderBook();
+        static request orderBook(const std::string& symbol, int limit = 1000);
         static request recentTrades();
         static request historicalTrades();
         static request aggregateTrades();
@@ -0,0 +1,49 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+#include "fin/Order.h"
+#include "bnb/utils/BNBRequests/RequestsBuilder.h"
+
+// Signed order request serialized once, fill() only writes the id, quantity, price,
+// timestamp and signature into fixed-width slots of the body. A slot holds its value
+// and closing quote, the rest is padded with JSON whitespace before the next token.
+// The signed query string is rebuilt from its fixed segments and the new values.
+class OrderTemplate
+{
+public:
+    // extraParams are fixed params sent with every order (e.g. timeInForce, computeCommissionRates)
+    OrderTemplate(const std::string& method, const std::string& symbol, Way side, OrderType type,
+                  const std::map<std::string, std::string>& extraParams = {});
+
+    // Not thread safe, the returned request is overwritten by the next fill
+    const request& fill(Qty quantity, Price price = Price());
+
+private:
+    enum Field { ID, QUANTITY, PRICE, TIMESTAMP, SIGNATURE, FIELD_COUNT };
+
+    struct Slot {
+        size_t offset = 0;
+        size_t width = 0;
+    };
+
+    struct QuerySegment {
+        std::string text;
+        Field field;
+    };
+
+    void build();
+    void writeSlot(Field field, const char* value, size_t size);
+
+    std::string method_;
+    std::map<std::string, std::string> params_;
+    bool hasPrice_;
+
+    // Session mode the layout was built for, a change rebuilds it (apiKey and signature)
+    bool authenticated_ = false;
+    Slot slots_[FIELD_COUNT];
+    std::vector<QuerySegment> querySegments_;
+    std::string querySuffix_;
+    std::string query_;
+    request request_;
+};
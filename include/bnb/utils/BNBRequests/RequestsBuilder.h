@@ -1,8 +1,10 @@
 #pragma once
 #include <string>
 #include <nlohmann/json.hpp>
-#include <sodium.h>
+#include <algorithm>
+#include <atomic>
 #include <map>
+#include <memory>
 #include "common/logger.hpp"
 #include "fin/Order.h"
 #include <iostream>
@@ -13,8 +15,11 @@
 #include <openssl/err.h>
 #include <openssl/evp.h>
 #include "bnb/utils/BNBRequests/RequestsHelper.h"
+#include "bnb/utils/BNBRequests/HmacSigner.h"
+#include "bnb/utils/BNBRequests/Ed25519Signer.h"
 
-using request = std::pair<std::string, std::string>;
+// Request id (see RequestsHelper::nextRequestId) and serialized body
+using request = std::pair<uint64_t, std::string>;
 
 class RequestsBuilder
 {
@@ -22,23 +27,43 @@ public:
     static request basicRequest(const std::string& method);
     static request paramsUnsignedRequest(const std::string& method, const nlohmann::json& params);
     static request paramsSignedRequest(const std::string& method, std::map<std::string, std::string>& params);
+    // Once session.logon succeeded on every connected session, signed requests are built with
+    // only their timestamp (no apiKey nor signature). Only a hint, the broker signs them again
+    // for a session that is not logged on.
+    static void setSessionAuthenticated(bool authenticated);
+    static bool isSessionAuthenticated();
+    // A signed request built without signature
+    static bool needsSignature(const std::string& body);
+    // Same id, method and params, with the apiKey and signature
+    static std::string signRequest(const std::string& body);
+    static const std::string& getApiKey();
+
+    static constexpr size_t MAX_SIGNATURE_CHARS = std::max(HmacSigner::SIGNATURE_CHARS, Ed25519Signer::SIGNATURE_CHARS);
+    // Signs a query string with the configured key, returns the signature length
+    static size_t signPayload(std::string_view payload, char* signature);
 
 private:
+    // Adds the apiKey and signs the sorted params, returns the signature length
+    static size_t signParams(std::map<std::string, std::string>& params, char* signature);
+    static std::string writeBody(std::string_view id, const std::string& method, const std::map<std::string, std::string>& params,
+                                 const char* signature, size_t signatureChars);
+
     inline static RequestsBuilder* instance = nullptr;
-    RequestsBuilder(const std::string& apiKey, const std::string& secretKey)
-     : apiKey_(apiKey), secretKey_(secretKey) {}
+    RequestsBuilder(const std::string& apiKey, const std::string& signMethod, const std::string& secret);
 
     std::string apiKey_;
-    std::string secretKey_;
-    bool loggedIn_{false};
+    std::unique_ptr<HmacSigner> hmacSigner_;
+    std::unique_ptr<Ed25519Signer> ed25519Signer_;
+    std::atomic<bool> sessionAuthenticated_{false};
 
 public:
     RequestsBuilder(const RequestsBuilder&) = delete;
     RequestsBuilder& operator=(const RequestsBuilder&) = delete;
 
-    // Static method to get the singleton instance
-    static RequestsBuilder* getInstance(const std::string& apiKey, const std::string& secretKey) {
-        instance = new RequestsBuilder(apiKey, secretKey);
+    // Static method to get the singleton instance, secret is the HMAC secret key or
+    // the Ed25519 PEM private key path depending on signMethod (HMAC or ED25519)
+    static RequestsBuilder* getInstance(const std::string& apiKey, const std::string& signMethod, const std::string& secret) {
+        instance = new RequestsBuilder(apiKey, signMethod, secret);
         return instance;
     }
 };
@@ -1,24 +1,34 @@
+#pragma once
 #include <string>
 #include <vector>
 #include <map> 
+#include <string_view>
+#include <cstdint>
 
-#include <openssl/hmac.h>
-#include <openssl/sha.h>
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-#include <boost/uuid/uuid_io.hpp>
 #include <fmt/ranges.h>
 
 class RequestsHelper
 {
 public:
-    static std::string generateED25519Signature(const std::string& secretKey, std::map<std::string, std::string>& params);
-    static void signRequestHMAC(std::map<std::string, std::string>& params, const std::string& apiKey ,const std::string& secretKey);
+    // "key=value&..." in the map (alphabetical) order, the payload Binance signs
+    static void appendQueryString(std::string& out, const std::map<std::string, std::string>& params);
+    // Quoted, escaped JSON string
+    static void appendJsonString(std::string& out, std::string_view text);
     static std::string getTimestamp();
-    static std::string generateRequestId();
+    // Exchange time in ms since epoch (see ExchangeClock), returns the end of the written range (out holds 20 chars)
+    static char* writeTimestamp(char* out);
 
-protected:
-    static std::string generateHMACSignature(const std::string& secretKey,const std::string& payload);
-    static std::string generatePayload(const std::map<std::string, std::string>& params);
-    
+    // Request ids are "<session prefix>-<counter>": the 8 hex prefix is drawn once per process,
+    // the counter is shared by all connections. The integer is what the broker keys its tables with.
+    static constexpr size_t REQUEST_ID_PREFIX_CHARS = 8;
+    static constexpr size_t MAX_REQUEST_ID_CHARS = REQUEST_ID_PREFIX_CHARS + 1 + 20;
+    struct RequestIdText {
+        char data[MAX_REQUEST_ID_CHARS];
+        size_t size;
+        std::string_view view() const { return std::string_view(data, size); }
+    };
+    static uint64_t nextRequestId();
+    static RequestIdText formatRequestId(uint64_t id);
+    // False for ids of another session or not generated here
+    static bool parseRequestId(std::string_view text, uint64_t& id);
 };
\ No newline at end of file
@@ -1,3 +1,4 @@
+#pragma once
 #include "bnb/utils/BNBRequests/RequestsBuilder.h"
 
 namespace BNBRequests
@@ -5,8 +6,8 @@ namespace BNBRequests
     class Trading
     {
     public:
-        static request placeNewOrder(const std::string& symbol, Way side, OrderType type, double quantity, double price=0);
-        static request testNewOrder(const std::string& symbol, Way side, OrderType type, double quantity, double price=0);
+        static request placeNewOrder(const std::string& symbol, Way side, OrderType type, Qty quantity, Price price=Price());
+        static request testNewOrder(const std::string& symbol, Way side, OrderType type, Qty quantity, Price price=Price());
         static request cancelOrders();
     };
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using InstrumentId = uint32_t;
+constexpr InstrumentId INVALID_INSTRUMENT_ID = std::numeric_limits<InstrumentId>::max();
+
+class Symbol;
+
+// Dense instrument ids assigned once at startup from the exchange information,
+// so the hot path can index flat arrays instead of looking symbols up by name.
+class InstrumentRegistry {
+public:
+    InstrumentRegistry() = default;
+    explicit InstrumentRegistry(const std::vector<Symbol>& symbols);
+
+    InstrumentId add(const std::string& symbol);
+    // Exchange symbol name, e.g. "BTCUSDT". Returns INVALID_INSTRUMENT_ID when unknown.
+    InstrumentId find(std::string_view symbol) const;
+    const std::string& getSymbol(InstrumentId id) const { return symbols_[id]; }
+    size_t size() const { return symbols_.size(); }
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    std::vector<std::string> symbols_;
+    std::unordered_map<std::string, InstrumentId, StringHash, std::equal_to<>> ids_;
+};
@@ -2,43 +2,43 @@
 #ifndef SYMBOL_FILTER_H
 #define SYMBOL_FILTER_H
 
-#include <cmath>
 #include <algorithm>
+#include "fin/Decimal.h"
 // Structs for various filters
 struct PriceFilter {
-    double minPrice;
-    double maxPrice;
-    double tickSize;
+    Price minPrice;
+    Price maxPrice;
+    Price tickSize;
 };
 
 struct LotSizeFilter {
-    double minQty;
-    double maxQty;
-    double stepSize;
+    Qty minQty;
+    Qty maxQty;
+    Qty stepSize;
 };
 
 struct MarketLotSizeFilter {
-    double minQty;
-    double maxQty;
-    double stepSize;
+    Qty minQty;
+    Qty maxQty;
+    Qty stepSize;
 };
 
 struct NotionalFilter {
-    double minNotional;
+    Qty minNotional;
     bool applyMinToMarket;
-    double maxNotional;
+    Qty maxNotional;
     bool applyMaxToMarket;
     int avgPriceMins;
 };
 
 struct MinNotionalFilter {
-    double minNotional;
+    Qty minNotional;
     bool applyToMarket;
     int avgPriceMins;
 };
 
 struct MaxPositionFilter {
-    double maxPosition;
+    Qty maxPosition;
 };
 
 // SymbolFilter Class
@@ -51,9 +51,6 @@ private:
     MinNotionalFilter minNotionalFilter;
     MaxPositionFilter maxPositionFilter;
 
-    // Helper function to round values
-    double roundToNearest(double value, double stepSize, bool roundUp);
-
 public:
     // Constructor
     SymbolFilter(
@@ -66,13 +63,15 @@ public:
     );
 
     // Methods
-    double roundPrice(double price, bool roundUp=false);
-    double roundQty(double qty, bool roundUp=false);
+    Price roundPrice(Price price, bool roundUp=false);
+    Qty roundQty(Qty qty, bool roundUp=false);
+
+    bool validatePrice(Price price);
+    bool validateQuantity(Qty quantity);
+    bool validateNotional(Price price, Qty quantity);
+    bool validateMaxPosition(Qty position);
 
-    bool validatePrice(double price);
-    bool validateQuantity(double quantity);
-    bool validateNotional(double price, double quantity);
-    bool validateMaxPosition(double position);
+    Price getTickSize() const { return priceFilter.tickSize; }
 };
 
 #endif // SYMBOL_FILTER_H
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RTEX_HAS_TSC 1
+#endif
+
+// Cheap wall clock in ns since epoch for hot path timestamps.
+// On x86 it reads the (invariant) TSC and maps it to system_clock with an
+// anchor taken at first use, elsewhere it falls back to system_clock.
+// resync() re-anchors and refines the tick rate over the elapsed interval,
+// it must only be called from one thread (e.g. a once per second metrics tick).
+class Clock {
+public:
+    static uint64_t now() {
+#ifdef RTEX_HAS_TSC
+        const State& s = state();
+        const Anchor& anchor = s.anchors[s.current.load(std::memory_order_acquire)];
+        int64_t ticks = static_cast<int64_t>(__rdtsc() - anchor.tsc);
+        return anchor.ns + static_cast<int64_t>(static_cast<double>(ticks) * anchor.nsPerTick);
+#else
+        return systemNow();
+#endif
+    }
+
+    static void resync() {
+#ifdef RTEX_HAS_TSC
+        State& s = state();
+        const Anchor& previous = s.anchors[s.current.load(std::memory_order_relaxed)];
+        Anchor next = sample();
+        if (next.tsc > previous.tsc && next.ns > previous.ns) {
+            next.nsPerTick = static_cast<double>(next.ns - previous.ns) / static_cast<double>(next.tsc - previous.tsc);
+        } else {
+            next.nsPerTick = previous.nsPerTick;
+        }
+        uint32_t slot = s.current.load(std::memory_order_relaxed) ^ 1;
+        s.anchors[slot] = next;
+        s.current.store(slot, std::memory_order_release);
+#endif
+    }
+
+    static uint64_t systemNow() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+private:
+#ifdef RTEX_HAS_TSC
+    struct Anchor {
+        uint64_t tsc = 0;
+        uint64_t ns = 0;
+        double nsPerTick = 1.0;
+    };
+
+    struct State {
+        Anchor anchors[2];
+        std::atomic<uint32_t> current{0};
+    };
+
+    // Tightest (tsc, system_clock) pair out of a few tries
+    static Anchor sample() {
+        Anchor best;
+        uint64_t bestWindow = UINT64_MAX;
+        for (int i = 0; i < 8; ++i) {
+            uint64_t before = __rdtsc();
+            uint64_t ns = systemNow();
+            uint64_t after = __rdtsc();
+            if (after - before < bestWindow) {
+                bestWindow = after - before;
+                best.tsc = before + (after - before) / 2;
+                best.ns = ns;
+            }
+        }
+        return best;
+    }
+
+    static bool calibrate(State& s) {
+        Anchor start = sample();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+        while (std::chrono::steady_clock::now() < deadline) {
+        }
+        Anchor end = sample();
+        end.nsPerTick = static_cast<double>(end.ns - start.ns) / static_cast<double>(end.tsc - start.tsc);
+        s.anchors[0] = end;
+        return true;
+    }
+
+    static State& state() {
+        static State s;
+        static const bool calibrated = calibrate(s);
+        (void)calibrated;
+        return s;
+    }
+#endif
+};
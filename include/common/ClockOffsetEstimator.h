@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// NTP style estimate of the exchange clock offset from request/response exchanges.
+// A sample is (local send, exchange time, local receive): the exchange is assumed to
+// stamp the request halfway through the round trip, so the error is bounded by rtt/2.
+// The estimate comes from the lowest rtt sample of the last WINDOW ones, the one the
+// least distorted by queuing.
+class ClockOffsetEstimator {
+public:
+    static constexpr size_t WINDOW = 8;
+
+    // Local times in ns (Clock::now()), exchange time in ms. Returns false for an unusable sample.
+    bool addSample(uint64_t sendNs, uint64_t receiveNs, uint64_t exchangeMs);
+
+    bool hasEstimate() const { return !samples_.empty(); }
+    // Exchange minus local time in ns
+    int64_t offsetNs() const { return best().offsetNs; }
+    uint64_t rttNs() const { return best().rttNs; }
+    size_t sampleCount() const { return count_; }
+
+private:
+    struct Sample {
+        int64_t offsetNs = 0;
+        uint64_t rttNs = 0;
+    };
+
+    const Sample& best() const;
+
+    std::vector<Sample> samples_;
+    size_t next_ = 0;
+    size_t count_ = 0;
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "common/SPSCQueue.h"
+#include "common/WaitStrategy.h"
+
+enum class DeliveryMode {
+    QUEUE,    // every update is delivered in arrival order
+    CONFLATE  // only the latest update of each key is delivered
+};
+
+inline DeliveryMode deliveryModeFromString(const std::string& name) {
+    if (name == "QUEUE") return DeliveryMode::QUEUE;
+    if (name == "CONFLATE") return DeliveryMode::CONFLATE;
+    throw std::runtime_error("Unknown delivery mode : <" + name + ">.");
+}
+
+// Latest-value slot table keyed by a dense id, with a dirty set of changed keys.
+// Each slot is a seqlock: writers take it by moving the sequence to odd, the
+// consumer copies the value and retries if the sequence moved. A key is queued
+// in its producer's dirty queue only when its dirty flag goes up, so a key is
+// never queued twice and the dirty queues can hold every key at once.
+template <typename T>
+class ConflatingMailbox {
+    static_assert(std::is_trivially_copyable_v<T>, "Conflated values are copied under a seqlock");
+
+public:
+    ConflatingMailbox(size_t keys, size_t producers)
+        : keys_(keys), slots_(std::make_unique<Slot[]>(keys)), delivered_(keys, 0)
+    {
+        for (size_t producer = 0; producer < producers; ++producer) {
+            dirty_.push_back(std::make_unique<SPSCQueue<uint32_t>>(keys));
+        }
+    }
+
+    ConflatingMailbox(const ConflatingMailbox&) = delete;
+    ConflatingMailbox& operator=(const ConflatingMailbox&) = delete;
+
+    // Producer side. replace(current, incoming) may refuse an out of order write.
+    // Returns true when the key was newly marked dirty.
+    template <typename Replace>
+    bool publish(size_t producer, uint32_t key, const T& value, Replace&& replace) {
+        Slot& slot = slots_[key];
+        uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+        while ((seq & 1) || !slot.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            RTEX_CPU_RELAX();
+            seq = slot.seq.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        bool written = (seq == 0) || replace(slot.value, value);
+        if (written) {
+            std::memcpy(&slot.value, &value, sizeof(T));
+        }
+        slot.seq.store(written ? seq + 2 : seq, std::memory_order_release);
+
+        if (!written || slot.dirty.exchange(true, std::memory_order_acq_rel)) {
+            return false;
+        }
+        dirty_[producer]->tryPush(key);
+        return true;
+    }
+
+    // Consumer side, dirty queues are polled round robin.
+    bool tryPop(T& out) {
+        for (size_t i = 0; i < dirty_.size(); ++i) {
+            SPSCQueue<uint32_t>& queue = *dirty_[next_];
+            next_ = (next_ + 1 == dirty_.size()) ? 0 : next_ + 1;
+            uint32_t key;
+            while (queue.tryPop(key)) {
+                if (read(key, out)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Consumer side, appends up to max changed values to out.
+    size_t drain(std::vector<T>& out, size_t max) {
+        size_t count = 0;
+        T value;
+        while (count < max && tryPop(value)) {
+            out.push_back(value);
+            ++count;
+        }
+        return count;
+    }
+
+    size_t keys() const { return keys_; }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<bool> dirty{false};
+        T value;
+    };
+
+    // False when the slot holds a version already delivered.
+    bool read(uint32_t key, T& out) {
+        Slot& slot = slots_[key];
+        // Clear first, a write landing after this re-queues the key
+        slot.dirty.store(false, std::memory_order_seq_cst);
+        uint64_t before, after;
+        do {
+            before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                RTEX_CPU_RELAX();
+                continue;
+            }
+            std::memcpy(&out, &slot.value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = slot.seq.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        if (before == delivered_[key]) {
+            return false;
+        }
+        delivered_[key] = before;
+        return true;
+    }
+
+    const size_t keys_;
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<std::unique_ptr<SPSCQueue<uint32_t>>> dirty_;
+    // Consumer only
+    std::vector<uint64_t> delivered_;
+    size_t next_ = 0;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "common/Clock.h"
+
+// Exchange time in ns since epoch: the TSC backed Clock::now() plus the offset
+// measured against the exchange (see ClockOffsetEstimator). The periodic samples
+// also absorb the drift of the TSC extrapolation, so until a first estimate (or
+// with the estimator disabled) the system clock is used instead.
+class ExchangeClock {
+public:
+    static uint64_t now() {
+        if (!isSynced()) {
+            return Clock::systemNow();
+        }
+        return Clock::now() + offset();
+    }
+
+    static uint64_t nowMs() {
+        return now() / 1000000;
+    }
+
+    // Exchange minus local time in ns, 0 until a first estimate
+    static int64_t offset() {
+        return offsetNs().load(std::memory_order_relaxed);
+    }
+
+    static void setOffset(int64_t ns) {
+        offsetNs().store(ns, std::memory_order_relaxed);
+        synced().store(true, std::memory_order_release);
+    }
+
+    static bool isSynced() {
+        return synced().load(std::memory_order_acquire);
+    }
+
+private:
+    static std::atomic<bool>& synced() {
+        static std::atomic<bool> value{false};
+        return value;
+    }
+
+    static std::atomic<int64_t>& offsetNs() {
+        static std::atomic<int64_t> offset{0};
+        return offset;
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+// Lock-free log2 bucketed latency histogram in ns. Bucket i counts samples in
+// [2^(i-1), 2^i), so percentiles are reported as the bucket upper bound
+// (at most 2x pessimistic). Any thread may record, readers get a best effort view.
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 64;
+
+    void record(uint64_t ns) {
+        buckets_[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (ns > max && !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Records end - start, samples where the clocks went backwards count as 0.
+    void record(uint64_t start, uint64_t end) {
+        record(end > start ? end - start : 0);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    double mean() const {
+        uint64_t n = count();
+        return n == 0 ? 0.0 : static_cast<double>(sum_.load(std::memory_order_relaxed)) / n;
+    }
+
+    // Upper bound in ns of the bucket holding the given quantile (0 < quantile <= 1).
+    uint64_t percentile(double quantile) const {
+        std::array<uint64_t, BUCKETS> counts;
+        uint64_t total = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(quantile * total);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen > rank || seen == total) {
+                return upperBound(i);
+            }
+        }
+        return max();
+    }
+
+private:
+    static size_t bucketOf(uint64_t ns) {
+        return ns == 0 ? 0 : std::min<size_t>(std::bit_width(ns), BUCKETS - 1);
+    }
+
+    static uint64_t upperBound(size_t bucket) {
+        return bucket == 0 ? 0 : (bucket >= BUCKETS - 1 ? UINT64_MAX : (uint64_t{1} << bucket) - 1);
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <websocketpp/config/asio_client.hpp>
+#include <websocketpp/message_buffer/message.hpp>
+
+// websocketpp message manager recycling messages and their payload buffers.
+// The default con_msg_manager allocates a message, its payload and a shared_ptr
+// control block for every frame; here the three come from per connection free
+// lists once the pool is warm. Payload strings are cleared, not shrunk, so a
+// recycled message keeps its capacity. Messages may be released from any thread.
+template <typename Message>
+class PooledConMsgManager : public websocketpp::lib::enable_shared_from_this<PooledConMsgManager<Message>> {
+public:
+    typedef PooledConMsgManager<Message> type;
+    typedef websocketpp::lib::shared_ptr<type> ptr;
+    typedef websocketpp::lib::weak_ptr<type> weak_ptr;
+    typedef typename Message::ptr message_ptr;
+
+    // Capacity reserved for new payloads, larger frames grow their buffer once
+    static constexpr size_t BUFFER_BYTES = 16 * 1024;
+    // Buffers grown past this (e.g. a large REST like response) are freed, not pooled
+    static constexpr size_t MAX_BUFFER_BYTES = 1024 * 1024;
+    static constexpr size_t MAX_FREE_MESSAGES = 64;
+
+    PooledConMsgManager() : pool_(websocketpp::lib::make_shared<Pool>()) {}
+
+    message_ptr get_message() {
+        return acquire(websocketpp::frame::opcode::text, BUFFER_BYTES);
+    }
+
+    message_ptr get_message(websocketpp::frame::opcode::value op, size_t size) {
+        return acquire(op, size);
+    }
+
+    // Messages go back to the pool through their shared_ptr deleter
+    bool recycle(Message*) { return false; }
+
+private:
+    struct Pool {
+        std::mutex mutex;
+        std::vector<Message*> messages;
+        std::vector<void*> blocks;
+        size_t blockBytes = 0;
+
+        ~Pool() {
+            for (Message* message : messages) {
+                delete message;
+            }
+            for (void* block : blocks) {
+                ::operator delete(block);
+            }
+        }
+    };
+
+    struct Recycler {
+        websocketpp::lib::shared_ptr<Pool> pool;
+
+        void operator()(Message* message) const {
+            if (message->get_raw_payload().capacity() <= MAX_BUFFER_BYTES) {
+                std::lock_guard<std::mutex> lock(pool->mutex);
+                if (pool->messages.size() < MAX_FREE_MESSAGES) {
+                    pool->messages.push_back(message);
+                    return;
+                }
+            }
+            delete message;
+        }
+    };
+
+    // Allocates the shared_ptr control blocks, all of the same size, from the pool
+    template <typename T>
+    struct BlockAllocator {
+        typedef T value_type;
+        template <typename U>
+        struct rebind { typedef BlockAllocator<U> other; };
+
+        websocketpp::lib::shared_ptr<Pool> pool;
+
+        explicit BlockAllocator(websocketpp::lib::shared_ptr<Pool> p) : pool(std::move(p)) {}
+        template <typename U>
+        BlockAllocator(const BlockAllocator<U>& other) : pool(other.pool) {}
+
+        T* allocate(size_t n) {
+            size_t bytes = n * sizeof(T);
+            {
+                std::lock_guard<std::mutex> lock(pool->mutex);
+                if (bytes == pool->blockBytes && !pool->blocks.empty()) {
+                    void* block = pool->blocks.back();
+                    pool->blocks.pop_back();
+                    return static_cast<T*>(block);
+                }
+                if (pool->blockBytes == 0) {
+                    pool->blockBytes = bytes;
+                }
+            }
+            return static_cast<T*>(::operator new(bytes));
+        }
+
+        void deallocate(T* block, size_t n) {
+            size_t bytes = n * sizeof(T);
+            {
+                std::lock_guard<std::mutex> lock(pool->mutex);
+                if (bytes == pool->blockBytes && pool->blocks.size() < MAX_FREE_MESSAGES) {
+                    pool->blocks.push_back(block);
+                    return;
+                }
+            }
+            ::operator delete(block);
+        }
+
+        template <typename U>
+        bool operator==(const BlockAllocator<U>& other) const { return pool == other.pool; }
+        template <typename U>
+        bool operator!=(const BlockAllocator<U>& other) const { return pool != other.pool; }
+    };
+
+    message_ptr acquire(websocketpp::frame::opcode::value op, size_t size) {
+        Message* message = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(pool_->mutex);
+            if (!pool_->messages.empty()) {
+                message = pool_->messages.back();
+                pool_->messages.pop_back();
+            }
+        }
+        if (message == nullptr) {
+            message = new Message(type::shared_from_this(), op, std::max(size, BUFFER_BYTES));
+        } else {
+            message->set_opcode(op);
+            message->set_fin(true);
+            message->set_terminal(false);
+            message->set_compressed(false);
+            message->set_prepared(false);
+            message->set_header("");
+            message->get_raw_payload().clear();
+            message->get_raw_payload().reserve(size);
+        }
+        return message_ptr(message, Recycler{pool_}, BlockAllocator<Message>(pool_));
+    }
+
+    websocketpp::lib::shared_ptr<Pool> pool_;
+};
+
+template <typename ConMsgManager>
+class PooledEndpointMsgManager {
+public:
+    typedef typename ConMsgManager::ptr con_msg_man_ptr;
+
+    con_msg_man_ptr get_manager() const {
+        return websocketpp::lib::make_shared<ConMsgManager>();
+    }
+};
+
+// asio TLS client config with pooled messages
+struct PooledTlsClientConfig : public websocketpp::config::asio_tls_client {
+    typedef PooledTlsClientConfig type;
+
+    typedef websocketpp::message_buffer::message<PooledConMsgManager> message_type;
+    typedef PooledConMsgManager<message_type> con_msg_manager_type;
+    typedef PooledEndpointMsgManager<con_msg_manager_type> endpoint_msg_manager_type;
+};
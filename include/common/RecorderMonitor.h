@@ -2,19 +2,35 @@
 #include <prometheus/exposer.h>
 #include <prometheus/gauge.h>
 #include <prometheus/registry.h>
-#include <unordered_map>
+#include <vector>
 #include <thread>
 #include <atomic>
 #include <string>
 #include <memory>
 #include "common/logger.hpp"
+#include "bnb/utils/InstrumentRegistry.h"
+#include "common/LatencyHistogram.h"
+#include <array>
+#include <map>
 
 class RecorderMonitor: public prometheus::Exposer{
 public:
     RecorderMonitor(const std::string& date);
     ~RecorderMonitor();
 
-    void updateMetrics(double runTimeSeconds, double timeUntilStopSeconds, int subscribedInstruments, const std::string& instrument);
+    void setInstrumentRegistry(const InstrumentRegistry& registry);
+    // Cheap per frame accounting, published to prometheus by updateMetrics.
+    void countUpdate(InstrumentId instrument) {
+        if (pendingUpdates_[instrument]++ == 0) {
+            dirtyInstruments_.push_back(instrument);
+        }
+    }
+    void updateMetrics(double runTimeSeconds, double timeUntilStopSeconds, int subscribedInstruments);
+    void updateShardMetrics(const std::vector<uint64_t>& shardUpdates);
+    void updateLegMetrics(const std::vector<uint64_t>& legWins, uint64_t duplicates);
+    // Exports p50/p99/p999/max of a latency stage of a stream type
+    void updateLatencyMetrics(const std::string& stream, const std::string& stage, const LatencyHistogram& histogram);
+    void updateReconnectMetrics(uint64_t reconnects, uint64_t failedReconnects);
     int getUpdatesCount();
 
 private:
@@ -23,6 +39,20 @@ private:
     prometheus::Gauge& runTimeGauge_;
     prometheus::Gauge& timeUntilStopGauge_;
     prometheus::Gauge& subscribedInstrumentsGauge_;
+    prometheus::Gauge& reconnectsGauge_;
+    prometheus::Gauge& failedReconnectsGauge_;
 
-    std::unordered_map<std::string, prometheus::Counter*> updatesCounterMap_;
+    const InstrumentRegistry* instruments_ = nullptr;
+    // Indexed by instrument id, counters are registered on first update.
+    std::vector<prometheus::Counter*> updatesCounters_;
+    std::vector<uint64_t> pendingUpdates_;
+    // Instruments with pending updates, so publishing only walks the ones that changed
+    std::vector<InstrumentId> dirtyInstruments_;
+    // Indexed by feeder connection
+    std::vector<prometheus::Gauge*> shardUpdatesGauges_;
+    // Indexed by redundant feeder leg
+    std::vector<prometheus::Gauge*> legWinsGauges_;
+    prometheus::Gauge* duplicatesGauge_ = nullptr;
+    // Keyed by stream + stage
+    std::map<std::string, std::array<prometheus::Gauge*, 4>> latencyGauges_;
 };
\ No newline at end of file
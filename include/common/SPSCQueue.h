@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Bounded lock-free single-producer/single-consumer ring buffer.
+// Head and tail live on their own cache lines, and each side keeps a cached
+// copy of the other side's index so the shared line is only read when the
+// ring looks full (producer) or empty (consumer).
+template <typename T>
+class SPSCQueue {
+public:
+    explicit SPSCQueue(size_t capacity)
+        : capacity_(roundUpPow2(capacity)), mask_(capacity_ - 1), buffer_(std::make_unique<T[]>(capacity_))
+    {
+        if (capacity == 0) {
+            throw std::runtime_error("[SPSCQueue] Capacity must be greater than 0");
+        }
+    }
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    // Producer side
+    template <typename U>
+    bool tryPush(U&& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ == capacity_) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ == capacity_) {
+                return false;
+            }
+        }
+        buffer_[tail & mask_] = std::forward<U>(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool tryPop(T& out) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) {
+                return false;
+            }
+        }
+        out = std::move(buffer_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, moves up to max elements to the back of out and publishes
+    // the new head once for the whole batch.
+    size_t tryPopMany(std::vector<T>& out, size_t max) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (max > tailCache_ - head) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+        }
+        const size_t count = std::min(tailCache_ - head, max);
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back(std::move(buffer_[(head + i) & mask_]));
+        }
+        if (count != 0) {
+            head_.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    static size_t roundUpPow2(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> buffer_;
+
+    // Consumer-owned line
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    size_t tailCache_{0};
+    // Producer-owned line
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+    size_t headCache_{0};
+};
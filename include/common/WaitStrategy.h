@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RTEX_CPU_RELAX() _mm_pause()
+#else
+#define RTEX_CPU_RELAX() do {} while (0)
+#endif
+
+enum class WaitStrategy {
+    BUSY_SPIN,   // never leaves the cpu, lowest wake-up latency
+    SPIN_YIELD,  // spins for a while then yields the time slice
+    BLOCKING     // parks the consumer on a futex until the producer rings
+};
+
+inline WaitStrategy waitStrategyFromString(const std::string& name) {
+    if (name == "BUSY_SPIN") return WaitStrategy::BUSY_SPIN;
+    if (name == "SPIN_YIELD") return WaitStrategy::SPIN_YIELD;
+    if (name == "BLOCKING") return WaitStrategy::BLOCKING;
+    throw std::runtime_error("Unknown wait strategy : <" + name + ">.");
+}
+
+// Consumer-side idle policy for lock-free queues.
+// Producers call notify() after publishing, the consumer calls wait() with a
+// non-blocking pop attempt. Only the BLOCKING strategy touches the doorbell,
+// and atomic::notify_one skips the futex syscall when nobody is parked.
+class QueueWaiter {
+public:
+    explicit QueueWaiter(WaitStrategy strategy, uint32_t spinCount = 1024)
+        : strategy_(strategy), spinCount_(spinCount) {}
+
+    void notify() {
+        if (strategy_ == WaitStrategy::BLOCKING) {
+            doorbell_.fetch_add(1, std::memory_order_release);
+            doorbell_.notify_one();
+        }
+    }
+
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        doorbell_.fetch_add(1, std::memory_order_release);
+        doorbell_.notify_all();
+    }
+
+    void open() { closed_.store(false, std::memory_order_release); }
+    bool isClosed() const { return closed_.load(std::memory_order_acquire); }
+
+    // Calls tryPop until it succeeds or the waiter is closed.
+    // Returns false only if closed with nothing left to pop.
+    template <typename TryPop>
+    bool wait(TryPop&& tryPop) {
+        uint32_t spins = 0;
+        while (true) {
+            const uint32_t ticket = doorbell_.load(std::memory_order_acquire);
+            if (tryPop()) {
+                return true;
+            }
+            if (isClosed()) {
+                return tryPop();
+            }
+            switch (strategy_) {
+                case WaitStrategy::BUSY_SPIN:
+                    RTEX_CPU_RELAX();
+                    break;
+                case WaitStrategy::SPIN_YIELD:
+                    if (++spins < spinCount_) {
+                        RTEX_CPU_RELAX();
+                    } else {
+                        std::this_thread::yield();
+                    }
+                    break;
+                case WaitStrategy::BLOCKING:
+                    doorbell_.wait(ticket, std::memory_order_acquire);
+                    break;
+            }
+        }
+    }
+
+    WaitStrategy strategy() const { return strategy_; }
+
+private:
+    const WaitStrategy strategy_;
+    const uint32_t spinCount_;
+    std::atomic<bool> closed_{false};
+    alignas(64) std::atomic<uint32_t> doorbell_{0};
+};
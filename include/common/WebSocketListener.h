@@ -6,8 +6,11 @@
 #include <string>
 #include <condition_variable>
 #include <mutex>
+#include <atomic>
+#include "common/WebSocketOptions.h"
+#include "common/PooledMessageManager.h"
 
-using wsppclient = websocketpp::client<websocketpp::config::asio_tls_client>;
+using wsppclient = websocketpp::client<PooledTlsClientConfig>;
 using sslcontext = websocketpp::lib::asio::ssl::context;
 
 class WebSocketListener {
@@ -15,26 +18,46 @@ public:
     WebSocketListener();
     virtual ~WebSocketListener();
 
+    // Must be set before connect
+    void setOptions(const WebSocketOptions& options) { options_ = options; }
+    uint64_t getPollIterations() const { return pollIterations_.load(std::memory_order_relaxed); }
+    uint64_t getPollIdleIterations() const { return pollIdleIterations_.load(std::memory_order_relaxed); }
+
     void connect(const std::string& uri);
+    // Before spawning the thread running startClient
+    void resetClient();
     void startClient();
+    // Before startClient, the io loop keeps running without a connection so timers still
+    // fire and the owner may connect again from one of them
+    void keepRunning();
     void stopClient();
     void writeWS(const std::string& message);
+    // Does not wait for the connection, false when it is not open or the write failed
+    bool tryWriteWS(const std::string& message);
+    // handler runs on the io thread, with an error when the timer is cancelled or the client stopped
+    wsppclient::timer_ptr setTimer(long durationMs, websocketpp::transport::timer_handler handler);
 
 protected:
     virtual void onOpen(websocketpp::connection_hdl hdl);
     virtual void onClose(websocketpp::connection_hdl hdl);
     virtual void onFail(websocketpp::connection_hdl hdl);
+    // msg is a pooled buffer recycled once released, parse it in place rather than copying the payload
     virtual void onMessage(websocketpp::connection_hdl hdl, wsppclient::message_ptr msg) = 0;
 
     std::shared_ptr<sslcontext> on_tls_init();
+    void onSocketInit(websocketpp::connection_hdl hdl, websocketpp::lib::asio::ssl::stream<websocketpp::lib::asio::ip::tcp::socket>& socket);
     websocketpp::connection_hdl hdl_;
 
 private:
     std::condition_variable connectionCond_;
-    bool isConnected_ = false;
+    std::atomic<bool> isConnected_{false};
     std::mutex connectionMutex_;
     bool use_tls_;
     wsppclient tls_client_;
     wsppclient::connection_ptr con_;
+
+    WebSocketOptions options_;
+    std::atomic<uint64_t> pollIterations_{0};
+    std::atomic<uint64_t> pollIdleIterations_{0};
 };
 
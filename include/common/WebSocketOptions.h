@@ -0,0 +1,13 @@
+#pragma once
+
+struct WebSocketOptions {
+    // Drive the io context with poll() in a spin loop instead of sleeping in epoll
+    bool busyPoll = false;
+    // Core the io thread is pinned to, -1 leaves placement to the scheduler
+    int cpu = -1;
+    bool tcpNoDelay = true;
+    // SO_BUSY_POLL in microseconds, 0 keeps the system default
+    int soBusyPollUs = 0;
+    // SO_RCVBUF in bytes, 0 keeps the system default
+    int rcvBufBytes = 0;
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Scaled integer decimal with the 8 fractional digits used by Binance for
+// every price and quantity. The tag keeps prices and quantities from being
+// mixed up at compile time.
+template <typename Tag>
+class Decimal {
+public:
+    static constexpr int DECIMALS = 8;
+    static constexpr int64_t SCALE = 100000000;
+    // Longest formatted value: sign, 11 integer digits, dot, 8 decimals.
+    static constexpr size_t MAX_CHARS = 21;
+
+    constexpr Decimal() = default;
+
+    static constexpr Decimal fromRaw(int64_t raw) { Decimal d; d.raw_ = raw; return d; }
+    static constexpr Decimal max() { return fromRaw(std::numeric_limits<int64_t>::max()); }
+    static Decimal fromDouble(double value) { return fromRaw(std::llround(value * SCALE)); }
+
+    // Parses "123.45600000" like strings, digits past the 8th decimal are truncated.
+    // Values out of the int64 range (above 92233720368.54775807) are rejected.
+    static bool parse(std::string_view text, Decimal& out) {
+        static constexpr int64_t POW10[DECIMALS + 1] = {
+            100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1
+        };
+        const char* p = text.data();
+        const char* end = p + text.size();
+        bool negative = (p < end && *p == '-');
+        p += negative;
+
+        // At most 11 integer digits are accumulated, the exact bound is checked below
+        int64_t integer = 0;
+        const char* intStart = p;
+        while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+            if (p - intStart == 11) {
+                return false;
+            }
+            integer = integer * 10 + (*p++ - '0');
+        }
+        size_t intDigits = p - intStart;
+
+        int64_t fraction = 0;
+        size_t fracDigits = 0;
+        if (p < end && *p == '.') {
+            ++p;
+            while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+                if (fracDigits < DECIMALS) {
+                    fraction = fraction * 10 + (*p - '0');
+                    ++fracDigits;
+                }
+                ++p;
+            }
+        }
+        if (p != end || (intDigits == 0 && fracDigits == 0)) {
+            return false;
+        }
+        fraction *= POW10[fracDigits];
+        if (integer > (std::numeric_limits<int64_t>::max() - fraction) / SCALE) {
+            return false;
+        }
+        int64_t raw = integer * SCALE + fraction;
+        out.raw_ = negative ? -raw : raw;
+        return true;
+    }
+
+    static Decimal fromString(std::string_view text) {
+        Decimal d;
+        if (!parse(text, d)) {
+            throw std::runtime_error("Invalid decimal value : <" + std::string(text) + ">.");
+        }
+        return d;
+    }
+
+    // Writes the value without trailing zeros, returns the end of the written range.
+    // out must hold at least MAX_CHARS characters.
+    char* toChars(char* out) const {
+        uint64_t magnitude = (raw_ < 0) ? 0 - static_cast<uint64_t>(raw_) : static_cast<uint64_t>(raw_);
+        if (raw_ < 0) {
+            *out++ = '-';
+        }
+        out = std::to_chars(out, out + 20, magnitude / SCALE).ptr;
+        uint64_t fraction = magnitude % SCALE;
+        if (fraction != 0) {
+            *out++ = '.';
+            char digits[DECIMALS];
+            for (int i = DECIMALS - 1; i >= 0; --i) {
+                digits[i] = static_cast<char>('0' + fraction % 10);
+                fraction /= 10;
+            }
+            int len = DECIMALS;
+            while (digits[len - 1] == '0') {
+                --len;
+            }
+            for (int i = 0; i < len; ++i) {
+                *out++ = digits[i];
+            }
+        }
+        return out;
+    }
+
+    std::string to_str() const {
+        char buffer[MAX_CHARS];
+        return std::string(buffer, toChars(buffer));
+    }
+
+    constexpr int64_t raw() const { return raw_; }
+    double toDouble() const { return static_cast<double>(raw_) / SCALE; }
+    constexpr bool isZero() const { return raw_ == 0; }
+
+    // Exact rounding to a multiple of step (tick size or lot step).
+    constexpr Decimal roundToStep(Decimal step, bool roundUp = false) const {
+        if (step.raw_ == 0) return *this;
+        int64_t remainder = raw_ % step.raw_;
+        if (remainder == 0) return *this;
+        return fromRaw(roundUp ? raw_ - remainder + step.raw_ : raw_ - remainder);
+    }
+
+    constexpr bool isMultipleOf(Decimal step) const {
+        return step.raw_ == 0 || raw_ % step.raw_ == 0;
+    }
+
+    constexpr auto operator<=>(const Decimal&) const = default;
+
+    constexpr Decimal operator+(Decimal other) const { return fromRaw(raw_ + other.raw_); }
+    constexpr Decimal operator-(Decimal other) const { return fromRaw(raw_ - other.raw_); }
+    constexpr Decimal& operator+=(Decimal other) { raw_ += other.raw_; return *this; }
+    constexpr Decimal& operator-=(Decimal other) { raw_ -= other.raw_; return *this; }
+
+private:
+    int64_t raw_ = 0;
+};
+
+struct PriceTag {};
+struct QtyTag {};
+
+using Price = Decimal<PriceTag>;
+using Qty = Decimal<QtyTag>;
+
+// price * quantity, expressed as a quantity of the quote asset (truncated to 8 decimals)
+inline Qty notional(Price price, Qty quantity) {
+    __int128 product = static_cast<__int128>(price.raw()) * quantity.raw() / Price::SCALE;
+    return Qty::fromRaw(static_cast<int64_t>(product));
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "fin/Symbol.h"
+#include "fin/Decimal.h"
 
 
 enum class Way {
@@ -18,24 +19,24 @@ private:
     Symbol _symbol;
     Way _way;
     OrderType _type;
-    double _quantity;
-    double _price;
+    Qty _quantity;
+    Price _price;
 
 public:
-    Order(const Symbol& symbol, Way way, OrderType type = OrderType::MARKET, double quantity = 0.0, double price = 0.0) 
+    Order(const Symbol& symbol, Way way, OrderType type = OrderType::MARKET, Qty quantity = Qty(), Price price = Price()) 
         : _symbol(symbol), _way(way), _type(type), _quantity(quantity), _price(price) {}
 
     Way getWay() const { return _way; }
     Symbol getSymbol() const { return _symbol; }
 
-    double getQty() const { return _quantity; }
-    void setQty(double value) { _quantity = value; }
+    Qty getQty() const { return _quantity; }
+    void setQty(Qty value) { _quantity = value; }
 
     OrderType getType() const { return _type; }
     void setType(OrderType value) { _type = value; }
 
-    double getPrice() const { return _price; }
-    void setPrice(double value) { _price = value; }
+    Price getPrice() const { return _price; }
+    void setPrice(Price value) { _price = value; }
 
     std::string getStartingAsset() const { return (_way == Way::BUY) ? _symbol.getQuote() : _symbol.getBase();}
     std::string getResultingAsset() const { return (_way == Way::BUY) ? _symbol.getBase() : _symbol.getQuote();}
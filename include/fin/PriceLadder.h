@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "fin/Decimal.h"
+
+enum class BookSide { BID, ASK };
+
+// One side of a price level book stored as a flat array of quantities indexed
+// by tick offset from an anchor. Ask ticks are negated so that on both sides a
+// higher index is a better price and the best level is the highest non empty slot.
+// The window spans `ticks` price levels and slides when the best price leaves it,
+// levels falling out on the far side are dropped (only deep levels are lost).
+// An occupancy bitmap (one bit per slot) lets the walks skip empty ticks 64 at a time.
+class PriceLadder {
+public:
+    struct Level {
+        Price price;
+        Qty qty;
+    };
+
+    PriceLadder(BookSide side, Price tickSize, size_t ticks) :
+        side_(side),
+        tick_(tickSize.raw()),
+        qty_(ticks),
+        occupied_((ticks + 63) / 64) {
+        if (tick_ <= 0 || ticks < 8) {
+            throw std::runtime_error("[PRICE_LADDER] Invalid tick size or ladder size.");
+        }
+    }
+
+    void clear() {
+        std::fill(qty_.begin(), qty_.end(), Qty());
+        std::fill(occupied_.begin(), occupied_.end(), 0);
+        best_ = -1;
+        levels_ = 0;
+    }
+
+    // Sets the quantity resting at price, 0 removes the level.
+    // Returns false when the level is too deep to fit in the window and was dropped.
+    bool update(Price price, Qty qty) {
+        int64_t key = keyOf(price);
+        int64_t i = key - anchor_;
+        if (i < 0 || i >= size()) {
+            if (qty.isZero()) {
+                return true;
+            }
+            if (!recenter(key)) {
+                ++dropped_;
+                return false;
+            }
+            i = key - anchor_;
+        }
+        Qty& slot = qty_[i];
+        if (qty.isZero()) {
+            if (!slot.isZero()) {
+                slot = Qty();
+                occupied_[i >> 6] &= ~bit(i);
+                --levels_;
+                if (i == best_) {
+                    best_ = nextWorse(i);
+                }
+            }
+            return true;
+        }
+        if (slot.isZero()) {
+            occupied_[i >> 6] |= bit(i);
+            ++levels_;
+        }
+        slot = qty;
+        best_ = std::max(best_, i);
+        return true;
+    }
+
+    bool empty() const { return best_ < 0; }
+    size_t levelCount() const { return levels_; }
+    // Levels dropped because they were outside the window
+    uint64_t getDroppedLevels() const { return dropped_; }
+
+    Price bestPrice() const { return empty() ? Price() : priceOf(best_); }
+    Qty bestQty() const { return empty() ? Qty() : qty_[best_]; }
+
+    Qty qtyAt(Price price) const {
+        int64_t i = keyOf(price) - anchor_;
+        return (i < 0 || i >= size()) ? Qty() : qty_[i];
+    }
+
+    // Writes up to n levels from the best outwards, returns the number written.
+    size_t top(Level* out, size_t n) const {
+        size_t count = 0;
+        for (int64_t i = best_; i >= 0 && count < n; i = nextWorse(i)) {
+            out[count++] = Level{priceOf(i), qty_[i]};
+        }
+        return count;
+    }
+
+    // Total quantity resting from the best level up to and including limit
+    // (bids priced >= limit, asks priced <= limit).
+    Qty cumulativeQty(Price limit) const {
+        Qty total;
+        int64_t last = std::max<int64_t>(keyOf(limit) - anchor_, 0);
+        for (int64_t i = best_; i >= last; i = nextWorse(i)) {
+            total += qty_[i];
+        }
+        return total;
+    }
+
+private:
+    int64_t size() const { return static_cast<int64_t>(qty_.size()); }
+    int64_t keyOf(Price price) const {
+        int64_t tick = price.raw() / tick_;
+        return side_ == BookSide::BID ? tick : -tick;
+    }
+    Price priceOf(int64_t i) const {
+        int64_t key = anchor_ + i;
+        return Price::fromRaw((side_ == BookSide::BID ? key : -key) * tick_);
+    }
+
+    static uint64_t bit(int64_t i) { return uint64_t(1) << (i & 63); }
+
+    // Highest occupied index below i, -1 if none
+    int64_t nextWorse(int64_t i) const {
+        if (--i < 0) {
+            return -1;
+        }
+        int64_t word = i >> 6;
+        uint64_t bits = occupied_[word] & (~uint64_t(0) >> (63 - (i & 63)));
+        while (bits == 0) {
+            if (--word < 0) {
+                return -1;
+            }
+            bits = occupied_[word];
+        }
+        return word * 64 + 63 - std::countl_zero(bits);
+    }
+
+    void rebuildOccupancy() {
+        std::fill(occupied_.begin(), occupied_.end(), 0);
+        for (int64_t i = 0; i < size(); ++i) {
+            if (!qty_[i].isZero()) {
+                occupied_[i >> 6] |= bit(i);
+            }
+        }
+    }
+
+    // Slides the window so key fits, keeping the best level inside it.
+    bool recenter(int64_t key) {
+        int64_t newAnchor;
+        if (empty()) {
+            newAnchor = key - size() * 3 / 4;
+        } else if (key >= anchor_ + size()) {
+            // Better than the window, leave a quarter of headroom above the new best
+            newAnchor = key - size() * 3 / 4;
+        } else if (anchor_ + best_ - key < size()) {
+            newAnchor = key;
+        } else {
+            return false;
+        }
+        shift(newAnchor - anchor_);
+        anchor_ = newAnchor;
+        return true;
+    }
+
+    void shift(int64_t delta) {
+        if (empty() || delta >= size() || -delta >= size()) {
+            dropped_ += levels_;
+            clear();
+            return;
+        }
+        Qty* data = qty_.data();
+        if (delta > 0) {
+            for (int64_t i = 0; i < delta; ++i) {
+                if (!data[i].isZero()) {
+                    --levels_;
+                    ++dropped_;
+                }
+            }
+            std::memmove(data, data + delta, (size() - delta) * sizeof(Qty));
+            std::fill(data + size() - delta, data + size(), Qty());
+        } else if (delta < 0) {
+            std::memmove(data - delta, data, (size() + delta) * sizeof(Qty));
+            std::fill(data, data - delta, Qty());
+        }
+        // Slides are rare (the best price left the window), the bitmap is rebuilt
+        rebuildOccupancy();
+        best_ = (best_ - delta >= 0) ? best_ - delta : nextWorse(size());
+        if (best_ >= size()) {
+            best_ = nextWorse(size());
+        }
+    }
+
+    BookSide side_;
+    int64_t tick_;
+    std::vector<Qty> qty_;
+    std::vector<uint64_t> occupied_;
+    int64_t anchor_ = 0;   // key of qty_[0]
+    int64_t best_ = -1;    // index of the best level, -1 when empty
+    size_t levels_ = 0;
+    uint64_t dropped_ = 0;
+};
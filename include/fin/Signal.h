@@ -12,4 +12,6 @@ public:
     std::vector<Order> orders;
     std::string description;
     double pnl;
+    // Index of the path in the emitting strategy
+    size_t pathIndex = 0;
 };
\ No newline at end of file
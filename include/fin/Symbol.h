@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include "bnb/utils/SymbolFilter.h"
+#include "bnb/utils/InstrumentRegistry.h"
 
 class Symbol {
 private:
@@ -8,12 +9,15 @@ private:
     std::string _quote_asset;
     std::string symbol_;
     SymbolFilter filter_;
+    InstrumentId id_;
 
 public:
-    Symbol(const std::string& base, const std::string& quote, const std::string& symbol, const SymbolFilter& filter) 
-        : _base_asset(base), _quote_asset(quote) , symbol_(symbol), filter_(filter){
+    Symbol(const std::string& base, const std::string& quote, const std::string& symbol, const SymbolFilter& filter, InstrumentId id = INVALID_INSTRUMENT_ID) 
+        : _base_asset(base), _quote_asset(quote) , symbol_(symbol), filter_(filter), id_(id){
     }
 
+    InstrumentId getId() const { return id_; }
+
     std::string getSymbol() const { return symbol_; }
     std::string getQuote() const { return _quote_asset; }
     std::string getBase() const { return _base_asset; }
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <websocketpp/config/asio.hpp>
+#include <websocketpp/server.hpp>
+#include <nlohmann/json.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "fin/Decimal.h"
+#include "mock/MockExchangeConfig.h"
+
+// Local stand-in for the Binance endpoints, for load and latency tests without
+// the real exchange. A single TLS websocket server dispatches on the resource:
+//  - /ws and /stream serve the market streams (SUBSCRIBE/UNSUBSCRIBE, raw or
+//    combined envelopes) for <symbol>@bookTicker, @aggTrade and @depth@100ms,
+//  - /ws-api/v3 serves the WS API subset used by the broker.
+// Quotes come from a random walk book per symbol or are replayed from recorder
+// files. Everything runs on the server io thread, signatures are not checked.
+class MockExchange {
+public:
+    explicit MockExchange(const MockExchangeConfig& config);
+
+    // Blocks until SIGINT/SIGTERM
+    void run();
+
+private:
+    using server = websocketpp::server<websocketpp::config::asio_tls>;
+    using sslcontext = websocketpp::lib::asio::ssl::context;
+    using Book = std::map<int64_t, int64_t>;  // price in ticks -> raw quantity
+
+    struct Subscriber {
+        websocketpp::connection_hdl hdl;
+        bool combined;
+    };
+
+    struct Quote {
+        Price bidPrice;
+        Qty bidQty;
+        Price askPrice;
+        Qty askQty;
+    };
+
+    struct Instrument {
+        std::string symbol;
+        std::string baseAsset;
+        std::string quoteAsset;
+        Price tickSize;
+        int64_t midTick = 0;
+        Book bids;
+        Book asks;
+        uint64_t updateId = 1;
+        // Levels changed since the last depth diff, sent every 100ms
+        uint64_t firstPendingId = 0;
+        Book pendingBids;
+        Book pendingAsks;
+        uint64_t aggTradeId = 1;
+        uint64_t tradeId = 1;
+        double eventBudget = 0;
+        std::vector<Quote> replay;
+        size_t replayPosition = 0;
+        std::string bookTickerStream;
+        std::string aggTradeStream;
+        std::string depthStream;
+    };
+
+    struct Session {
+        enum class Channel { STREAM, COMBINED_STREAM, API } channel;
+        std::vector<std::string> streams;
+    };
+
+    struct ApiError : std::runtime_error {
+        ApiError(int c, const std::string& msg) : std::runtime_error(msg), code(c) {}
+        int code;
+    };
+
+    std::shared_ptr<sslcontext> onTlsInit(websocketpp::connection_hdl hdl);
+    void onOpen(websocketpp::connection_hdl hdl);
+    void onClose(websocketpp::connection_hdl hdl);
+    void onMessage(websocketpp::connection_hdl hdl, server::message_ptr msg);
+
+    void onStreamRequest(websocketpp::connection_hdl hdl, Session& session, const std::string& payload);
+    void subscribe(websocketpp::connection_hdl hdl, Session& session, const std::string& stream);
+    void unsubscribe(websocketpp::connection_hdl hdl, Session& session, const std::string& stream);
+    void onApiRequest(websocketpp::connection_hdl hdl, const std::string& payload);
+    nlohmann::json handleApi(const std::string& method, const nlohmann::json& params);
+
+    nlohmann::json exchangeInfo(const nlohmann::json& params);
+    nlohmann::json accountStatus();
+    nlohmann::json bookTicker(const nlohmann::json& params);
+    nlohmann::json depth(const nlohmann::json& params);
+    nlohmann::json placeOrder(const nlohmann::json& params, bool test);
+
+    void scheduleTick();
+    void onTick();
+    void generateEvent(Instrument& instrument);
+    void replayEvent(Instrument& instrument);
+    void setLevel(Instrument& instrument, bool bid, int64_t tick, int64_t qty);
+    void publishBookTicker(Instrument& instrument, uint64_t now);
+    void publishTrade(Instrument& instrument, uint64_t now);
+    void publishDepth(Instrument& instrument, uint64_t now);
+    void publish(const std::string& stream, const std::string& data);
+    void send(websocketpp::connection_hdl hdl, const std::string& payload);
+
+    Instrument& findInstrument(const std::string& symbol);
+    std::string price(const Instrument& instrument, int64_t tick) const;
+    void loadReplay(Instrument& instrument);
+
+    MockExchangeConfig config_;
+    server server_;
+    std::mt19937_64 rng_;
+    std::vector<Instrument> instruments_;
+    std::unordered_map<std::string, size_t> instrument_index_;
+    std::map<websocketpp::connection_hdl, Session, std::owner_less<websocketpp::connection_hdl>> sessions_;
+    std::unordered_map<std::string, std::vector<Subscriber>> subscribers_;
+    std::shared_ptr<sslcontext> tls_context_;
+    std::unique_ptr<websocketpp::lib::asio::steady_timer> tick_timer_;
+    uint64_t ticks_ = 0;
+    uint64_t order_id_ = 1;
+    uint64_t messages_sent_ = 0;
+};
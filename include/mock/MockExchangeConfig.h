@@ -0,0 +1,33 @@
+// MockExchangeConfig.h
+#ifndef MOCK_EXCHANGE_CONFIG_H
+#define MOCK_EXCHANGE_CONFIG_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct MockExchangeConfig {
+    uint16_t listenPort;
+    std::string certificateFile;
+    std::string privateKeyFile;
+    // Listed symbols with their starting price, "BTCUSDT:60000"
+    std::vector<std::pair<std::string, double>> symbols;
+    // Balances returned by account.status, "USDT:10000"
+    std::vector<std::pair<std::string, double>> balances;
+    // Book events per second and per symbol, each one may publish a bookTicker and an aggTrade
+    double eventRateHz;
+    // Share of book events that also print a trade
+    double tradeRatio;
+    // Recorder output directory (data/) and date to replay instead of generating quotes
+    std::string replayDir;
+    std::string replayDate;
+    // Delay added before answering WS API requests
+    uint32_t apiLatencyUs;
+    uint32_t apiLatencyJitterUs;
+    uint64_t seed;
+};
+
+MockExchangeConfig loadMockExchangeConfig(const std::string& configFile);
+
+#endif // MOCK_EXCHANGE_CONFIG_H
@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <vector>
 #include <map>
 #include <set>
@@ -26,26 +27,34 @@
 #include "bnb/marketConnection/BNBBroker.h"
 #include "bnb/marketConnection/BNBFeeder.h"
 #include "bnb/marketConnection/BNBMarketConnectionConfig.h"
+#include "bnb/marketData/BNBBookBuilder.h"
 
 #include "bnb/utils/BNBRequests/General.h"
 #include "bnb/utils/BNBRequests/Account.h"
 #include "bnb/utils/BNBRequests/MarketData.h"
 #include "bnb/utils/BNBRequests/Trading.h"
+#include "bnb/execution/BNBExecutor.h"
 #include "bnb/utils/ExchangeInfo.h"
+#include "bnb/utils/InstrumentRegistry.h"
 
 const double FEE = 0.1;
 const double RISK = 1.0;
 
 struct CircularArbConfig {
     std::string startingAsset;
+    ExecutionConfig execution;
+    // Price window of the L2 books the legs are sized against, 0 prices them off the book tickers
+    size_t orderBookTicks = 0;
 };
 
 class CircularArb : public IStrategy {
 public:
     CircularArb(const CircularArbConfig& config, const BNBMarketConnectionConfig& mcConfig);
-    virtual ~CircularArb() = default;
+    virtual ~CircularArb();
 
     std::optional<Signal> onMarketData(const BookTickerMDFrame& data) override;
+    // Applies the whole batch, then evaluates each affected path once.
+    std::optional<Signal> onMarketData(const std::vector<BookTickerMDFrame>& batch);
     void initialize() override;
     void shutdown() override;
     void run() override;
@@ -56,13 +65,33 @@ private:
     std::string startingAsset_;
     std::vector<std::vector<Order>> stratPaths_;
     std::set<std::string> stratSymbols_;
-    std::map<std::string, BookTickerMDFrame> marketData_;
+    InstrumentRegistry registry_;
+    // Indexed by instrument id, instrumentId stays invalid until the first update.
+    std::vector<BookTickerMDFrame> marketData_;
+    // Indexed by instrument id, the strategy paths that trade the instrument.
+    std::vector<std::vector<size_t>> instrumentPaths_;
+    // Batch evaluation, a path is queued once per batch using its epoch mark.
+    std::vector<uint32_t> pathEpochs_;
+    std::vector<size_t> dirtyPaths_;
+    uint32_t epoch_ = 0;
     std::map<std::string, double> balance_;
 
     BNBBroker broker_;
     BNBFeeder<BookTickerMDFrame> feeder_;
+    BNBExecutor executor_;
+    // Null unless orderBookTicks is set
+    std::unique_ptr<BNBBookBuilder> books_;
+    std::array<PriceLadder::Level, 64> sweepLevels_;
 
     std::vector<Order> getPossibleOrders(const std::string& coin, const std::vector<Symbol>& relatedSymbols);
     std::vector<std::vector<Order>> computeArbitragePaths(const std::vector<Symbol>& symbolsList, const std::string& startingAsset, int arbitrageDepth);
     std::optional<Signal> evaluatePath(std::vector<Order>& path);
+    std::optional<Signal> evaluatePaths(const std::vector<size_t>& paths);
+    std::vector<BookTickerMDFrame> requestBookTickers(const std::vector<std::string>& symbols);
+    std::vector<BookTickerMDFrame> parseBookTickers(const nlohmann::json& response) const;
+    // Walks the levels of side from the best one until amount (base quantity sold, or quote
+    // spent) is filled. False when the book holds less than that.
+    bool sweep(const PriceLadder& side, Way way, double amount, double& received, Price& worstPrice);
+
+    static constexpr size_t MAX_BATCH_SIZE = 1024;
 };
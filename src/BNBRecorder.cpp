@@ -4,6 +4,9 @@
 BNBRecorder::BNBRecorder(const BNBMarketConnectionConfig& config, const std::string& date, const std::string& symbol)
     : broker_(config), feeder_(config), date_(date), symbol_(symbol), scheduler_(date), monitor_(date){
     LOG_INFO("[RECORDER] Initialized with date: {} and symbol: {}", date_, symbol_);
+    if (config.feederDeliveryMode == DeliveryMode::CONFLATE) {
+        LOG_WARNING("[RECORDER] Feeder runs in CONFLATE delivery mode, intermediate updates will not be recorded.");
+    }
 }
 
 BNBRecorder::~BNBRecorder() {
@@ -27,20 +30,25 @@ bool BNBRecorder::startComponents() {
 std::vector<std::string> BNBRecorder::getSubscriptionList(const std::string& symbol)
 {
     std::vector<std::string> subscriptionList;
+
+    request req = BNBRequests::General::exchangeInformation({});
+    std::future<nlohmann::json> pending = broker_.sendRequest(req, RequestCosts::EXCHANGE_INFORMATION);
+    LOG_INFO("[RECORDER] Waiting for exchange info response...");
+
+    nlohmann::json response = pending.get();
+    ExchangeInfo exInfo(response);
+    registry_ = InstrumentRegistry(exInfo.getSymbols());
+    instrument_files_.resize(registry_.size());
+    file_dirty_.assign(registry_.size(), false);
+    monitor_.setInstrumentRegistry(registry_);
+    feeder_.setInstrumentRegistry(registry_);
+
     if (symbol_ == "all") 
     {
-        std::string requestId = broker_.sendRequest(&BNBRequests::getExchangeInfo, {});
-        LOG_INFO("[RECORDER] Waiting for exchange info response...");
-
-        nlohmann::json response = broker_.getResponseForId(requestId);
-        if (response.contains("result")) {
-            for (const auto& symbolInfo : response["result"]["symbols"]) {
-                if (symbolInfo["status"] != "TRADING")
-                    continue;
-                std::string symbol = symbolInfo["symbol"];
-                std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::tolower);
-                subscriptionList.push_back(symbol);
-            }
+        for (const auto& symbolInfo : exInfo.getSymbols()) {
+            std::string symbol = symbolInfo.to_str();
+            std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::tolower);
+            subscriptionList.push_back(symbol);
         }
         LOG_INFO("[RECORDER] Subscribing to all symbols...");
     }
@@ -62,23 +70,67 @@ void BNBRecorder::run() {
     auto subscribedTickerCount = feeder_.subscribeToTickers(subscriptionList);
 
     auto lastLogTime = std::chrono::system_clock::now();
+    auto lastShardMetricsTime = lastLogTime;
+    uint64_t lastPollIterations = 0;
+    uint64_t lastPollIdleIterations = 0;
     auto stopTime = scheduler_.getStopTime();
     auto startTime = scheduler_.getStartTime();
+    std::vector<BookTickerMDFrame> batch;
+    batch.reserve(MAX_BATCH_SIZE);
     while (std::chrono::system_clock::now() < stopTime) {
         try {
-            auto dataFrame = feeder_.getUpdate();
+            feeder_.drain(batch, MAX_BATCH_SIZE);
+            for (const auto& dataFrame : batch) {
+                monitor_.countUpdate(dataFrame.instrumentId);
+                recordData(dataFrame.instrumentId, dataFrame.to_str(registry_.getSymbol(dataFrame.instrumentId)));
+            }
+            flushFiles();
+
             std::chrono::seconds timeToStart = scheduler_.timeUntil(startTime);
             std::chrono::seconds timeToEnd = scheduler_.timeUntil(stopTime);
-            monitor_.updateMetrics(timeToStart.count(), timeToEnd.count(), subscribedTickerCount, dataFrame.symbol);
-            recordData(dataFrame.symbol, dataFrame.to_str());
+            monitor_.updateMetrics(timeToStart.count(), timeToEnd.count(), subscribedTickerCount);
 
             auto now = std::chrono::system_clock::now();
+            if (now - lastShardMetricsTime >= std::chrono::seconds(1)) {
+                monitor_.updateShardMetrics(feeder_.getShardUpdateCounts());
+                monitor_.updateLegMetrics(feeder_.getLegWinCounts(), feeder_.getDuplicateCount());
+                monitor_.updateLatencyMetrics(feeder_.getStreamName(), "feed", feeder_.getFeedLatency());
+                monitor_.updateLatencyMetrics(feeder_.getStreamName(), "parse", feeder_.getParseLatency());
+                monitor_.updateLatencyMetrics(feeder_.getStreamName(), "queue", feeder_.getQueueLatency());
+                monitor_.updateLatencyMetrics(feeder_.getStreamName(), "reconnect", feeder_.getReconnectLatency());
+                monitor_.updateReconnectMetrics(feeder_.getReconnectCount(), feeder_.getFailedReconnectCount());
+                Clock::resync();
+                lastShardMetricsTime = now;
+            }
             if (std::chrono::duration_cast<std::chrono::minutes>(now - lastLogTime).count() >= 30) {
 
                 auto now_c = std::chrono::system_clock::to_time_t(now);
                 std::ostringstream oss;
                 oss << std::put_time(std::gmtime(&now_c), "%Y-%m-%d %H:%M:%S");
                 LOG_INFO("[RECORDER] Periodic log - Current time: {}, Total updates: {}", oss.str(), monitor_.getUpdatesCount());
+                auto shardUpdates = feeder_.getShardUpdateCounts();
+                for (size_t shard = 0; shard < shardUpdates.size(); ++shard) {
+                    LOG_INFO("[RECORDER] Feeder connection {} - updates: {}", shard, shardUpdates[shard]);
+                }
+                const LatencyHistogram& parseLatency = feeder_.getParseLatency();
+                const LatencyHistogram& queueLatency = feeder_.getQueueLatency();
+                LOG_INFO("[RECORDER] Latency ns - parse p50: {} p99: {} max: {}, queue p50: {} p99: {} max: {}",
+                    parseLatency.percentile(0.5), parseLatency.percentile(0.99), parseLatency.max(),
+                    queueLatency.percentile(0.5), queueLatency.percentile(0.99), queueLatency.max());
+                uint64_t pollIterations = feeder_.getPollIterations();
+                uint64_t pollIdleIterations = feeder_.getPollIdleIterations();
+                if (pollIterations > lastPollIterations) {
+                    LOG_INFO("[RECORDER] Feeder busy poll - iterations: {}, idle ratio: {:.4f}", pollIterations - lastPollIterations,
+                        static_cast<double>(pollIdleIterations - lastPollIdleIterations) / (pollIterations - lastPollIterations));
+                }
+                lastPollIterations = pollIterations;
+                lastPollIdleIterations = pollIdleIterations;
+                LOG_INFO("[RECORDER] Feeder reconnects: {} (failed attempts: {}), reconnect p99: {} us",
+                    feeder_.getReconnectCount(), feeder_.getFailedReconnectCount(), feeder_.getReconnectLatency().percentile(0.99) / 1000);
+                auto legWins = feeder_.getLegWinCounts();
+                if (legWins.size() > 1) {
+                    LOG_INFO("[RECORDER] Feeder legs - A wins: {}, B wins: {}, duplicates dropped: {}", legWins[0], legWins[1], feeder_.getDuplicateCount());
+                }
                 
                 lastLogTime = now;
             }
@@ -92,14 +144,29 @@ void BNBRecorder::run() {
     LOG_INFO("[RECORDER] Target date has ended. Stopping recorder.");
 }
 
-void BNBRecorder::recordData(const std::string& ticker, const std::string& data) {
-    if (symbol_file_map_.find(ticker) == symbol_file_map_.end()) {
-        openFileForSymbol(ticker);
+void BNBRecorder::recordData(InstrumentId instrument, const std::string& data) {
+    std::ofstream& file = instrument_files_[instrument];
+    if (!file.is_open()) {
+        openFileForInstrument(instrument);
+    }
+    file << data << '\n';
+    if (!file_dirty_[instrument]) {
+        file_dirty_[instrument] = true;
+        dirty_files_.push_back(instrument);
+    }
+}
+
+// Files written during the batch are flushed once, rather than on every line.
+void BNBRecorder::flushFiles() {
+    for (InstrumentId instrument : dirty_files_) {
+        instrument_files_[instrument].flush();
+        file_dirty_[instrument] = false;
     }
-    symbol_file_map_[ticker] << data << std::endl;
+    dirty_files_.clear();
 }
 
-void BNBRecorder::openFileForSymbol(const std::string& ticker) {
+void BNBRecorder::openFileForInstrument(InstrumentId instrument) {
+    const std::string& ticker = registry_.getSymbol(instrument);
     std::string base_dir = "data/";
     std::string symbol_dir = base_dir + ticker + "/" + date_;
     std::string filename = symbol_dir + "/book.csv";
@@ -107,11 +174,11 @@ void BNBRecorder::openFileForSymbol(const std::string& ticker) {
 
     if (!file_exists) {
         fs::create_directories(symbol_dir);
-        symbol_file_map_[ticker] = std::ofstream(filename, std::ios_base::app);
+        instrument_files_[instrument] = std::ofstream(filename, std::ios_base::app);
         LOG_INFO("[RECORDER] File for symbol {} did not exist, creating and writing header.", ticker);
-        symbol_file_map_[ticker] << BookTickerMDFrame::getHeader() << std::endl;
+        instrument_files_[instrument] << BookTickerMDFrame::getHeader() << std::endl;
     } else {
-        symbol_file_map_[ticker] = std::ofstream(filename, std::ios_base::app);
+        instrument_files_[instrument] = std::ofstream(filename, std::ios_base::app);
         LOG_INFO("[RECORDER] Appending data to existing file for symbol {}: {}", ticker, filename);
     }
 
@@ -119,10 +186,10 @@ void BNBRecorder::openFileForSymbol(const std::string& ticker) {
 }
 
 void BNBRecorder::closeFiles() {
-    for (auto& pair : symbol_file_map_) {
-        if (pair.second.is_open()) {
-            LOG_INFO("[RECORDER] Closing file for symbol: {}", pair.first);
-            pair.second.close();
+    for (InstrumentId instrument = 0; instrument < instrument_files_.size(); ++instrument) {
+        if (instrument_files_[instrument].is_open()) {
+            LOG_INFO("[RECORDER] Closing file for symbol: {}", registry_.getSymbol(instrument));
+            instrument_files_[instrument].close();
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "bnb/execution/BNBExecutor.h"
+#include <algorithm>
+
+namespace {
+    const char* statusName(int status) {
+        static constexpr const char* NAMES[] = {"PENDING", "SENT", "ACKED", "FILLED", "REJECTED"};
+        return NAMES[status];
+    }
+
+    double decimalField(const nlohmann::json& result, const char* field) {
+        return Qty::fromString(result.value(field, "0")).toDouble();
+    }
+}
+
+ExecutionMode parseExecutionMode(const std::string& mode) {
+    if (mode == "PIPELINED") {
+        return ExecutionMode::PIPELINED;
+    }
+    if (mode == "SEQUENTIAL") {
+        return ExecutionMode::SEQUENTIAL;
+    }
+    throw std::runtime_error("[EXECUTOR] Unknown execution mode : <" + mode + ">");
+}
+
+BNBExecutor::BNBExecutor(BNBBroker& broker, const ExecutionConfig& config)
+    : broker_(broker), config_(config),
+      orderCost_(config.testOrders ? RequestCosts::ORDER_TEST_COMMISSION : RequestCosts::ORDER)
+{
+    LOG_INFO("[EXECUTOR] Executing signals {} with {}", config_.mode == ExecutionMode::PIPELINED ? "PIPELINED" : "SEQUENTIAL",
+             config_.testOrders ? "order.test" : "order.place");
+}
+
+size_t BNBExecutor::addPath(const std::vector<Order>& path) {
+    std::map<std::string, std::string> extraParams;
+    if (config_.testOrders) {
+        extraParams["computeCommissionRates"] = "true";
+    } else {
+        extraParams["newOrderRespType"] = "FULL";
+    }
+    std::vector<OrderTemplate> templates;
+    templates.reserve(path.size());
+    for (const Order& order : path) {
+        templates.emplace_back(config_.testOrders ? "order.test" : "order.place", order.getSymbol().to_str(),
+                               order.getWay(), order.getType(), extraParams);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    orderTemplates_.push_back(std::move(templates));
+    return orderTemplates_.size() - 1;
+}
+
+bool BNBExecutor::execute(const Signal& signal) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (execution_.active) {
+        return false;
+    }
+    if (signal.pathIndex >= orderTemplates_.size() || orderTemplates_[signal.pathIndex].size() != signal.orders.size()) {
+        throw std::runtime_error("[EXECUTOR] Signal for an unknown path : " + signal.description);
+    }
+    execution_.sequence = ++sequence_;
+    execution_.pathIndex = signal.pathIndex;
+    execution_.description = signal.description;
+    execution_.legs.clear();
+    for (const Order& order : signal.orders) {
+        execution_.legs.push_back(Leg{order});
+    }
+    execution_.completedLegs = 0;
+    execution_.active = true;
+
+    size_t legsToSend = (config_.mode == ExecutionMode::PIPELINED) ? execution_.legs.size() : 1;
+    for (size_t leg = 0; leg < legsToSend; ++leg) {
+        if (!sendLeg(leg)) {
+            break;
+        }
+    }
+    if (execution_.completedLegs == execution_.legs.size()) {
+        complete();
+    }
+    return true;
+}
+
+bool BNBExecutor::isBusy() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return execution_.active;
+}
+
+bool BNBExecutor::sendLeg(size_t leg) {
+    Leg& current = execution_.legs[leg];
+    uint64_t sequence = execution_.sequence;
+    try {
+        const request& req = orderTemplates_[execution_.pathIndex][leg].fill(current.order.getQty(), current.order.getPrice());
+        current.status = LegStatus::SENT;
+        current.sendTime = Clock::now();
+        broker_.sendRequest(req, [this, sequence, leg](nlohmann::json response) {
+            onResponse(sequence, leg, response);
+        }, orderCost_);
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR("[EXECUTOR] Failed to send leg {} ({}) : {}", leg, current.order.to_str(), e.what());
+        abortFrom(leg);
+        return false;
+    }
+}
+
+// Legs from leg on that are not out yet will never be sent
+void BNBExecutor::abortFrom(size_t leg) {
+    for (size_t i = leg; i < execution_.legs.size(); ++i) {
+        Leg& aborted = execution_.legs[i];
+        if (i == leg || aborted.status == LegStatus::PENDING) {
+            aborted.status = LegStatus::REJECTED;
+            ++execution_.completedLegs;
+        }
+    }
+}
+
+void BNBExecutor::onResponse(uint64_t sequence, size_t leg, const nlohmann::json& response) {
+    uint64_t now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!execution_.active || execution_.sequence != sequence) {
+        return;
+    }
+    Leg& current = execution_.legs[leg];
+    current.ackTime = now;
+    // Synthetic responses of the broker would record the timeout itself as a latency
+    auto error = response.find("error");
+    if (error != response.end() && error->is_object() && error->value("code", 0) == BNBBroker::TIMEOUT_ERROR_CODE) {
+        timeouts_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        ack_latency_.record(current.sendTime, now);
+    }
+    LOG_DEBUG("[EXECUTOR] Leg {} ({}) response : {}", leg, current.order.to_str(), response.dump());
+
+    auto result = response.find("result");
+    if (error != response.end() || result == response.end()) {
+        current.status = LegStatus::REJECTED;
+        LOG_ERROR("[EXECUTOR] Leg {} ({}) rejected : {}", leg, current.order.to_str(), response.dump());
+    } else if (result->value("status", "") == "FILLED") {
+        current.status = LegStatus::FILLED;
+        current.fillTime = now;
+        fill_latency_.record(current.sendTime, now);
+        bool buy = current.order.getWay() == Way::BUY;
+        current.received = decimalField(*result, buy ? "executedQty" : "cummulativeQuoteQty");
+        for (const auto& fill : result->value("fills", nlohmann::json::array())) {
+            if (fill.value("commissionAsset", "") == current.order.getResultingAsset()) {
+                current.received -= decimalField(fill, "commission");
+            }
+        }
+    } else {
+        current.status = LegStatus::ACKED;
+    }
+    ++execution_.completedLegs;
+
+    if (config_.mode == ExecutionMode::SEQUENTIAL && leg + 1 < execution_.legs.size()) {
+        if (current.status == LegStatus::REJECTED) {
+            abortFrom(leg + 1);
+        } else {
+            if (current.status == LegStatus::FILLED) {
+                sizeNextLeg(leg);
+            }
+            sendLeg(leg + 1);
+        }
+    }
+    if (execution_.completedLegs == execution_.legs.size()) {
+        complete();
+    }
+}
+
+// The next leg trades what the filled leg actually received instead of the theoretical amount
+void BNBExecutor::sizeNextLeg(size_t leg) {
+    Order& next = execution_.legs[leg + 1].order;
+    double available = execution_.legs[leg].received;
+    if (next.getWay() == Way::BUY) {
+        if (next.getPrice().isZero()) {
+            return;
+        }
+        available /= next.getPrice().toDouble();
+    }
+    Qty quantity = next.getSymbol().getFilter().roundQty(Qty::fromDouble(available));
+    LOG_DEBUG("[EXECUTOR] Leg {} ({}) resized from {} to {}", leg + 1, next.to_str(), next.getQty().to_str(), quantity.to_str());
+    next.setQty(quantity);
+}
+
+void BNBExecutor::complete() {
+    uint64_t firstSend = 0;
+    uint64_t lastResponse = 0;
+    std::string legsReport;
+    for (const Leg& leg : execution_.legs) {
+        if (leg.sendTime != 0 && (firstSend == 0 || leg.sendTime < firstSend)) {
+            firstSend = leg.sendTime;
+        }
+        lastResponse = std::max(lastResponse, leg.ackTime);
+        legsReport += fmt::format(" [{} {} ack {} us fill {} us]", leg.order.to_str(), statusName(static_cast<int>(leg.status)),
+                                  leg.ackTime ? (leg.ackTime - leg.sendTime) / 1000 : 0,
+                                  leg.fillTime ? (leg.fillTime - leg.sendTime) / 1000 : 0);
+    }
+    if (firstSend != 0 && lastResponse != 0) {
+        signal_latency_.record(firstSend, lastResponse);
+    }
+    LOG_INFO("[EXECUTOR] Signal {} executed in {} us :{}", execution_.description,
+             (firstSend != 0 && lastResponse > firstSend) ? (lastResponse - firstSend) / 1000 : 0, legsReport);
+    execution_.active = false;
+}
+
+void BNBExecutor::logStats() const {
+    auto logHistogram = [](const char* name, const LatencyHistogram& histogram) {
+        LOG_INFO("[EXECUTOR] {} latency over {} samples : mean {:.0f} us, p50 {} us, p99 {} us, max {} us", name, histogram.count(),
+                 histogram.mean() / 1000, histogram.percentile(0.5) / 1000, histogram.percentile(0.99) / 1000, histogram.max() / 1000);
+    };
+    logHistogram("Send to ack", ack_latency_);
+    logHistogram("Send to fill", fill_latency_);
+    logHistogram("Signal", signal_latency_);
+    LOG_INFO("[EXECUTOR] {} legs timed out", getTimeoutCount());
+}
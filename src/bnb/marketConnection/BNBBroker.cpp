@@ -1,26 +1,54 @@
 #include "bnb/marketConnection/BNBBroker.h"
 
+#include <algorithm>
+#include <bit>
 
-BNBBroker::BNBBroker(const BNBMarketConnectionConfig& config): 
-    apiKey_(config.apiKey), 
+
+BNBBroker::BNBBroker(const BNBMarketConnectionConfig& config):
+    apiKey_(config.apiKey),
     uri_(config.apiWsEndpoint),
     loginOnConnection_(config.loginOnConnection),
-    signMethod_(config.signMethod)
+    signMethod_(config.signMethod),
+    dispatch_(config.brokerDispatch),
+    requestTimeout_(config.apiRequestTimeoutMs),
+    rateLimiter_(config.rateLimitOrderReserveWeight, config.rateLimitBulkReserveWeight),
+    clockSyncIntervalMs_(config.clockSyncIntervalMs)
 {
     if (signMethod_=="HMAC")
     {
-        secretKey_ = config.apiSecret;
+        RequestsBuilder::getInstance(apiKey_, signMethod_, config.apiSecret);
     }
-    else if ((signMethod_=="ED25519") || (signMethod_=="RSA")) 
+    else if (signMethod_=="ED25519")
     {
-        secretKey_ = loadPrivateKey(config.privateKeyPath);
+        RequestsBuilder::getInstance(apiKey_, signMethod_, config.privateKeyPath);
     }
     else
     {
         throw std::runtime_error("[BNBBroker] Binance API sign method unsupported : <"+signMethod_+">.");
     }
-    RequestsBuilder::getInstance(apiKey_, secretKey_);
-    LOG_INFO("[BNBBroker] BNBBroker initialized with API Endpoint: {}, sign method used : {}", uri_, signMethod_);
+    size_t sessionCount = config.brokerOrderSessions + config.brokerQuerySessions;
+    if (config.brokerOrderSessions == 0 || sessionCount > MAX_SESSIONS)
+    {
+        throw std::runtime_error("[BNBBroker] At least one ORDERS session and at most " + std::to_string(MAX_SESSIONS) + " sessions are supported.");
+    }
+    for (size_t index = 0; index < sessionCount; ++index)
+    {
+        SessionRole role = index < config.brokerOrderSessions ? SessionRole::ORDERS : SessionRole::QUERIES;
+        sessions_.push_back(std::make_unique<BNBBrokerSession>(*this, index, role, uri_,
+            std::chrono::milliseconds(config.wsReconnectBackoffMs), std::chrono::milliseconds(config.wsReconnectMaxBackoffMs)));
+        (role == SessionRole::ORDERS ? orderSessions_ : querySessions_).push_back(index);
+        // Only the first ORDERS session busy polls, on the broker core
+        WebSocketOptions options = config.wsOptions;
+        options.busyPoll = index == 0 && options.busyPoll;
+        options.cpu = index == 0 ? config.brokerBusyPollCpu : -1;
+        sessions_.back()->setOptions(options);
+    }
+    if (querySessions_.empty())
+    {
+        querySessions_ = orderSessions_;
+    }
+    LOG_INFO("[BNBBroker] BNBBroker initialized with API Endpoint: {}, sign method used : {}, {} ORDERS and {} QUERIES sessions, {} dispatch",
+             uri_, signMethod_, config.brokerOrderSessions, config.brokerQuerySessions, dispatch_ == BrokerDispatch::HEDGED ? "HEDGED" : "LEAST_LOADED");
 }
 
 BNBBroker::~BNBBroker() {
@@ -29,138 +57,625 @@ BNBBroker::~BNBBroker() {
 }
 
 void BNBBroker::start() {
-    bws_thread_ = std::thread([this]() {
-        brunning_ = true;
-        connect(uri_);
-        WebSocketListener::startClient();
-    });
+    brunning_ = true;
+    for (auto& session : sessions_)
+    {
+        session->start();
+    }
+    waitSessionsUp();
+    if (clockSyncIntervalMs_ > 0)
+    {
+        syncClock();
+    }
     if (loginOnConnection_)
     {
-        LOG_INFO("[BNBBroker] Logging in ...");
         if (signMethod_ != "ED25519")
         {
             throw std::runtime_error("[BNBBroker] Unsupported login on connection with sign method : " + signMethod_);
         }
-        auto req = BNBRequests::Authentication::logIn();
-        loginRequestId_ = sendRequest(req.first, req.second);
+        for (auto& session : sessions_)
+        {
+            if (session->isUp())
+            {
+                logIn(*session);
+            }
+        }
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        relogIn_ = true;
+        // Connected while the others were logging in
+        for (auto& session : sessions_)
+        {
+            if (session->isUp() && !session->isLoggedIn())
+            {
+                logOn(*session, nullptr);
+            }
+        }
+    }
+}
+
+// Requests are only written on connected sessions, the ones still down after the request
+// timeout keep reconnecting in the background
+void BNBBroker::waitSessionsUp() {
+    {
+        std::unique_lock<std::mutex> lock(sessions_mutex_);
+        sessions_cv_.wait_for(lock, requestTimeout_, [this] {
+            return std::all_of(sessions_.begin(), sessions_.end(), [](const auto& session) { return session->isUp(); });
+        });
+    }
+    for (const auto& session : sessions_) {
+        if (!session->isUp()) {
+            LOG_WARNING("[BNBBroker] Session {} not connected after {} ms, reconnecting", session->getName(), requestTimeout_.count());
+        }
+    }
+    if (std::none_of(orderSessions_.begin(), orderSessions_.end(), [this](size_t index) { return sessions_[index]->isUp(); })) {
+        throw std::runtime_error("[BNBBroker] No ORDERS session connected after " + std::to_string(requestTimeout_.count()) + " ms.");
+    }
+}
+
+// Blocking, at start only
+void BNBBroker::logIn(BNBBrokerSession& session) {
+    LOG_INFO("[BNBBroker] Logging in session {} ...", session.getName());
+    std::promise<bool> answered;
+    std::future<bool> loggedIn = answered.get_future();
+    if (!logOn(session, [&answered](bool success) { answered.set_value(success); })) {
+        return;
+    }
+    if (!loggedIn.get()) {
+        throw std::runtime_error("[BNBBroker] Authorization failed see error above");
+    }
+}
+
+// session.logon authenticates the current connection of the session, signed requests it
+// sends then skip apiKey and signature. The answer is dropped once the session reconnected.
+bool BNBBroker::logOn(BNBBrokerSession& session, std::function<void(bool)> done) {
+    uint64_t connection = session.getConnection();
+    if (!session.claimLogOn(connection)) {
+        return false;
+    }
+    sendRequestOn(session.getIndex(), BNBRequests::Authentication::logIn(), [this, &session, connection, done](nlohmann::json response) {
+        bool loggedIn = false;
+        if (response.contains("result") && !response.contains("error")) {
+            std::string apiKey = response["result"].value("apiKey", "");
+            uint64_t authorizedSince = response["result"].value("authorizedSince", uint64_t(0));
+            loggedIn = !apiKey.empty() && authorizedSince > 0;
+            if (!loggedIn) {
+                LOG_ERROR("[BNBBroker] Authorization failed, response apiKey: {}, authorizedSince: {}", apiKey, authorizedSince);
+            }
+        }
+        if (session.getConnection() != connection) {
+            LOG_WARNING("[BNBBroker] Session {} reconnected before its logon was answered", session.getName());
+            loggedIn = false;
+        } else if (loggedIn) {
+            session.setLoggedIn(true);
+            LOG_INFO("[BNBBroker] Session {} authenticated", session.getName());
+            updateAuthentication();
+        } else {
+            LOG_ERROR("[BNBBroker] Session {} not logged on, its requests stay signed", session.getName());
+        }
+        if (done) {
+            done(loggedIn);
+        }
+    }, requestTimeout_, RequestCosts::SESSION);
+    return true;
+}
+
+// The builder flag only picks the form signed requests are built in, dispatch signs them
+// again for a session that is not logged on
+void BNBBroker::updateAuthentication() {
+    std::lock_guard<std::mutex> lock(login_mutex_);
+    bool authenticated = false;
+    for (const auto& session : sessions_) {
+        if (session->isUp()) {
+            if (!session->isLoggedIn()) {
+                authenticated = false;
+                break;
+            }
+            authenticated = true;
+        }
+    }
+    if (authenticated == RequestsBuilder::isSessionAuthenticated()) {
+        return;
+    }
+    RequestsBuilder::setSessionAuthenticated(authenticated);
+    if (authenticated) {
+        LOG_INFO("[BNBBroker] Every connected session logged on, signed requests are built without signature");
+    } else {
+        LOG_WARNING("[BNBBroker] A connected session is not logged on, signed requests are built with their signature");
+    }
+}
+
+// A few samples before anything gets signed, then one per interval in the background
+void BNBBroker::syncClock() {
+    for (size_t i = 0; i < CLOCK_SYNC_INITIAL_SAMPLES; ++i) {
+        std::promise<void> sampled;
+        std::future<void> done = sampled.get_future();
+        sampleClock([&sampled]() { sampled.set_value(); });
+        done.wait();
+    }
+    LOG_INFO("[BNBBroker] Exchange clock offset {} us, round trip {} us", ExchangeClock::offset() / 1000, clockEstimator_.rttNs() / 1000);
+    scheduleClockSync();
+}
+
+void BNBBroker::sampleClock(std::function<void()> done) {
+    uint64_t sendTime = Clock::now();
+    sendRequestOn(firstUp(orderSessions_), BNBRequests::General::checkServerTime(), [this, sendTime, done](nlohmann::json response) {
+        uint64_t receiveTime = Clock::now();
+        auto result = response.find("result");
+        if (result != response.end() && clockEstimator_.addSample(sendTime, receiveTime, result->value("serverTime", uint64_t(0)))) {
+            ExchangeClock::setOffset(clockEstimator_.offsetNs());
+            LOG_DEBUG("[BNBBroker] Clock sample rtt {} us, offset estimate {} us", (receiveTime - sendTime) / 1000, clockEstimator_.offsetNs() / 1000);
+        }
+        done();
+    }, requestTimeout_, RequestCosts::SERVER_TIME);
+}
+
+// First connected session of candidates, the first one when none is
+size_t BNBBroker::firstUp(const std::vector<size_t>& candidates) const {
+    for (size_t index : candidates) {
+        if (sessions_[index]->isUp()) {
+            return index;
+        }
     }
+    return candidates.front();
+}
+
+void BNBBroker::scheduleClockSync() {
+    if (!brunning_) {
+        return;
+    }
+    clock_timer_ = sessions_[orderSessions_.front()]->setTimer(clockSyncIntervalMs_, [this](const websocketpp::lib::error_code& ec) {
+        if (ec) {
+            return;
+        }
+        try {
+            sampleClock([this]() { scheduleClockSync(); });
+        } catch (const std::exception& e) {
+            LOG_WARNING("[BNBBroker] Clock sample not sent : {}", e.what());
+            scheduleClockSync();
+        }
+    });
 }
 
 void BNBBroker::stop() {
     if (brunning_) {
-        LOG_INFO("[BNBBroker] Stopping BNBBroker WebSocket connection...");
-        stopClient();
+        LOG_INFO("[BNBBroker] Stopping BNBBroker WebSocket connections...");
         brunning_ = false;
-        if (bws_thread_.joinable()) {
-            bws_thread_.join();
-            LOG_INFO("[BNBBroker] WebSocket connection thread joined.");
+        for (auto& session : sessions_) {
+            session->stop();
+            LOG_INFO("[BNBBroker] Session {} stopped, {} requests sent.", session->getName(), session->getSentCount());
         }
+        failPending("Broker stopped");
+        LOG_INFO("[BNBBroker] Rate limits usage : {}", rateLimiter_.describe(nowMs()));
     }
 }
 
-std::string BNBBroker::sendRequest(const std::string& requestId, const std::string& requestBody)
-{
-    LOG_INFO("[BNBBroker] Sending request");
-    // if (loginOnConnection_ && !(std::is_same<decltype(func), decltype(&BNBRequests::logIn)>::value))
-    // {
-    //     LOG_INFO("[BNBBroker] Waiting for login");
-    //     std::unique_lock<std::mutex> lock(login_mutex_);
-    //     login_cv_.wait(lock, [this] { return is_logged_in_; });
-    // }
+void BNBBroker::sendRequest(const request& req, ResponseCallback callback, RequestCost cost) {
+    sendRequestOn(ANY_SESSION, req, std::move(callback), requestTimeout_, cost);
+}
 
-    {
-        std::lock_guard<std::mutex> lock(response_mutex_);
-        pending_requests_.insert(requestId);
+void BNBBroker::sendRequest(const request& req, ResponseCallback callback, std::chrono::milliseconds timeout, RequestCost cost) {
+    sendRequestOn(ANY_SESSION, req, std::move(callback), timeout, cost);
+}
+
+void BNBBroker::sendRequestOn(size_t session, const request& req, ResponseCallback callback, std::chrono::milliseconds timeout, RequestCost cost) {
+    uint64_t now = nowMs();
+    if (cost.priority == RequestPriority::ORDER) {
+        if (!rateLimiter_.tryAcquire(cost, now)) {
+            throw std::runtime_error("[BNBBroker] Rate limit budget exhausted, request " + std::to_string(req.first) + " not sent : " + rateLimiter_.describe(now));
+        }
+        dispatch(req, std::move(callback), timeout, cost, session);
+        return;
     }
 
-    writeWS(requestBody);
-    LOG_INFO("[BNBBroker] Request sent, ID: {}", requestId);
-    return requestId;
+    // Requests of the same or a higher priority already waiting go first
+    std::unique_lock<std::mutex> lock(deferred_mutex_);
+    size_t priority = static_cast<size_t>(cost.priority);
+    bool queued = false;
+    for (size_t i = 0; i <= priority; ++i) {
+        queued = queued || !deferred_[i].empty();
+    }
+    if (!queued && rateLimiter_.tryAcquire(cost, now)) {
+        lock.unlock();
+        dispatch(req, std::move(callback), timeout, cost, session);
+        return;
+    }
+    deferred_[priority].push_back(DeferredRequest{req, std::move(callback), now + timeout.count(), cost, session});
+    ++deferred_count_;
+    scheduleDrain(now);
+    LOG_WARNING("[BNBBroker] Request {} deferred by the rate limiter, {} waiting : {}", req.first, deferred_count_, rateLimiter_.describe(now));
 }
 
-nlohmann::json BNBBroker::getResponseForId(const std::string& id) {
-    std::unique_lock<std::mutex> lock(response_mutex_);
+// Least loaded connected session of the request role, logged on ones first, none when every
+// one is down. A hedged request also takes the connected runner up when the rate limiter has
+// the budget of the second copy.
+uint32_t BNBBroker::pickSessions(const RequestCost& cost) {
+    const std::vector<size_t>& candidates = cost.priority == RequestPriority::ORDER ? orderSessions_ : querySessions_;
+    auto better = [this](size_t a, size_t b) {
+        if (sessions_[a]->isLoggedIn() != sessions_[b]->isLoggedIn()) {
+            return sessions_[a]->isLoggedIn();
+        }
+        return sessions_[a]->getLoad() < sessions_[b]->getLoad();
+    };
+    size_t best = ANY_SESSION;
+    size_t runnerUp = ANY_SESSION;
+    for (size_t index : candidates) {
+        if (!sessions_[index]->isUp()) {
+            continue;
+        }
+        if (best == ANY_SESSION || better(index, best)) {
+            runnerUp = best;
+            best = index;
+        } else if (runnerUp == ANY_SESSION || better(index, runnerUp)) {
+            runnerUp = index;
+        }
+    }
+    if (best == ANY_SESSION) {
+        return 0;
+    }
+    uint32_t sessions = uint32_t{1} << best;
+    bool hedged = dispatch_ == BrokerDispatch::HEDGED && cost.hedgeable && runnerUp != ANY_SESSION;
+    if (hedged && rateLimiter_.tryAcquire(cost, nowMs())) {
+        sessions |= uint32_t{1} << runnerUp;
+    }
+    return sessions;
+}
 
-    if (pending_requests_.find(id) == pending_requests_.end()) {
-        LOG_WARNING("[BNBBroker] Request ID not found: {}", id);
-        throw std::runtime_error("Request ID not found or no request was made with this ID.");
+void BNBBroker::dispatch(const request& req, ResponseCallback callback, std::chrono::milliseconds timeout, const RequestCost& cost, size_t session) {
+    uint64_t id = req.first;
+    uint32_t sessions = session == ANY_SESSION ? pickSessions(cost) : (sessions_[session]->isUp() ? uint32_t{1} << session : 0);
+    if (sessions == 0) {
+        rateLimiter_.release(cost, nowMs());
+        std::string target = session == ANY_SESSION ? std::string(cost.priority == RequestPriority::ORDER ? "ORDERS" : "QUERIES") : sessions_[session]->getName();
+        throw std::runtime_error("[BNBBroker] No " + target + " session connected, request " + std::to_string(id) + " not sent.");
+    }
+    // Built without signature for logged on sessions, one that is not needs it
+    const std::string* body = &req.second;
+    std::string signedBody;
+    for (size_t index = 0; loginOnConnection_ && index < sessions_.size(); ++index) {
+        if ((sessions & (uint32_t{1} << index)) && !sessions_[index]->isLoggedIn() && RequestsBuilder::needsSignature(req.second)) {
+            try {
+                signedBody = RequestsBuilder::signRequest(req.second);
+            } catch (const std::exception& e) {
+                refund(cost, sessions);
+                throw std::runtime_error("[BNBBroker] Request " + std::to_string(id) + " could not be signed : " + e.what());
+            }
+            body = &signedBody;
+            LOG_DEBUG("[BNBBroker] Request {} signed for session {}, not logged on", id, sessions_[index]->getName());
+            break;
+        }
+    }
+    // The io loop of a session runs while it reconnects, the timer fires whatever its connection
+    size_t timerSession = std::countr_zero(sessions);
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        if (pending_count_ == MAX_PENDING_REQUESTS) {
+            refund(cost, sessions);
+            throw std::runtime_error("[BNBBroker] Pending request table full, " + std::to_string(pending_count_) + " requests in flight.");
+        }
+        size_t slot = id % MAX_PENDING_REQUESTS;
+        while (pending_[slot].active) {
+            slot = (slot + 1) % MAX_PENDING_REQUESTS;
+        }
+        PendingRequest& pending = pending_[slot];
+        pending.id = id;
+        pending.callback = std::move(callback);
+        pending.active = true;
+        pending.sessions = sessions;
+        pending.timerSession = timerSession;
+        pending.timer = sessions_[timerSession]->setTimer(timeout.count(), [this, id](const websocketpp::lib::error_code& ec) {
+            if (!ec) {
+                onTimeout(id);
+            }
+        });
+        for (size_t index = 0; index < sessions_.size(); ++index) {
+            if (sessions & (uint32_t{1} << index)) {
+                sessions_[index]->addLoad();
+            }
+        }
+        ++pending_count_;
     }
 
-    LOG_INFO("[BNBBroker] Waiting for response for Request ID: {}", id);
-    response_cv_.wait(lock, [this, &id]() {
-        return stored_responses_.find(id) != stored_responses_.end();
-    });
+    uint32_t written = 0;
+    for (size_t index = 0; index < sessions_.size(); ++index) {
+        if ((sessions & (uint32_t{1} << index)) && sessions_[index]->tryWriteWS(*body)) {
+            written |= uint32_t{1} << index;
+        }
+    }
+    refund(cost, sessions & ~written);
+    if (written == 0) {
+        // Dropped between the pick and the write, nothing will answer
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        PendingRequest* pending = findPending(id);
+        if (pending) {
+            release(*pending, NO_SESSION);
+            throw std::runtime_error("[BNBBroker] Session down before request " + std::to_string(id) + " was written, not sent.");
+        }
+        return;
+    }
+    LOG_DEBUG("[BNBBroker] Request sent, ID: {}, sessions: {:#x}", id, sessions);
+}
 
-    LOG_INFO("[BNBBroker] Response received for Request ID: {}", id);
-    return stored_responses_[id];
+void BNBBroker::refund(const RequestCost& cost, uint32_t sessions) {
+    uint64_t now = nowMs();
+    for (int copy = 0; copy < std::popcount(sessions); ++copy) {
+        rateLimiter_.release(cost, now);
+    }
 }
 
-void BNBBroker::onMessage(websocketpp::connection_hdl hdl, websocketpp::client<websocketpp::config::asio_client>::message_ptr msg) {
-    try
-    {
-        std::string payload = msg->get_payload();
-        auto json_data = nlohmann::json::parse(payload);
+std::future<nlohmann::json> BNBBroker::sendRequest(const request& req, RequestCost cost) {
+    auto promise = std::make_shared<std::promise<nlohmann::json>>();
+    std::future<nlohmann::json> response = promise->get_future();
+    sendRequest(req, [promise](nlohmann::json json) { promise->set_value(std::move(json)); }, cost);
+    return response;
+}
 
-        std::lock_guard<std::mutex> lock(response_mutex_);
-        std::string id = json_data.value("id", "");
-        if (!id.empty()) {
-            bool isError=false;
-            if (json_data.contains("error")) {
-                int status = json_data.value("status", -1);
-                int errorCode = json_data["error"].value("code", 0);
-                std::string errorMsg = json_data["error"].value("msg", "Unknown error");
-                isError=true;
-                LOG_ERROR("[BNBBroker] Error received for message id {} : Status: {}, Code: {}, Message: {}", id, status, errorCode, errorMsg);
-            }
+// Drains at the next refill, or earlier when a deferred request times out first. A timer
+// superseded by an earlier one still fires, it only drains once more.
+void BNBBroker::scheduleDrain(uint64_t now) {
+    uint64_t drainAt = rateLimiter_.nextRefillMs(now);
+    for (const auto& queue : deferred_) {
+        for (const DeferredRequest& deferred : queue) {
+            drainAt = std::min(drainAt, deferred.deadlineMs);
+        }
+    }
+    if (drainAt >= drain_at_ms_) {
+        return;
+    }
+    drain_at_ms_ = drainAt;
+    // Armed on a connected session, QUERIES first, whose io loop keeps running if it drops
+    size_t session = firstUp(querySessions_);
+    if (!sessions_[session]->isUp()) {
+        session = firstUp(orderSessions_);
+    }
+    drain_timer_ = sessions_[session]->setTimer(static_cast<long>(drainAt - std::min(drainAt, now)) + 1, [this](const websocketpp::lib::error_code& ec) {
+        if (!ec) {
+            drainDeferred();
+        }
+    });
+}
 
-            if (id == loginRequestId_)
-            {
-                if (isError)
-                {
-                    throw std::runtime_error("[BNBBroker] Authorization failed see error above");
+// Runs on the io thread the drain was armed on once the budget was given back, highest priority first.
+// The timeout of a deferred request runs from its enqueue, it fails like a pending one when it expires.
+void BNBBroker::drainDeferred() {
+    std::vector<DeferredRequest> ready;
+    std::vector<DeferredRequest> expired;
+    uint64_t now = nowMs();
+    {
+        std::lock_guard<std::mutex> lock(deferred_mutex_);
+        drain_timer_.reset();
+        drain_at_ms_ = NO_DRAIN;
+        for (auto& queue : deferred_) {
+            for (auto it = queue.begin(); it != queue.end();) {
+                if (it->deadlineMs > now) {
+                    ++it;
+                    continue;
                 }
-                std::unique_lock<std::mutex> lock(login_mutex_);
-                if (json_data.contains("result")) {
-                    std::string apiKey = json_data["result"].value("apiKey", "");
-                    std::string authorizedSince = json_data["result"].value("authorizedSince", "");
-                    if (apiKey.empty() || authorizedSince.empty())
-                    {
-                        throw std::runtime_error("[BNBBroker] Authorization failed see error above, response apiKey: "+apiKey+", authorizedSince: "+authorizedSince);
-                    }
-                    login_cv_.notify_all();
+                expired.push_back(std::move(*it));
+                it = queue.erase(it);
+                --deferred_count_;
+            }
+        }
+        bool blocked = false;
+        for (auto& queue : deferred_) {
+            while (!blocked && !queue.empty()) {
+                if (!rateLimiter_.tryAcquire(queue.front().cost, now)) {
+                    blocked = true;
+                    break;
                 }
-            } 
+                ready.push_back(std::move(queue.front()));
+                queue.pop_front();
+                --deferred_count_;
+            }
+        }
+        if (deferred_count_ > 0) {
+            scheduleDrain(now);
+        }
+    }
+    for (DeferredRequest& deferred : expired) {
+        LOG_WARNING("[BNBBroker] Deferred request {} timed out waiting for rate limit budget", deferred.req.first);
+        deferred.callback(errorResponse(deferred.req.first, 408, TIMEOUT_ERROR_CODE, "Timeout waiting for rate limit budget"));
+    }
+    for (DeferredRequest& deferred : ready) {
+        try {
+            std::chrono::milliseconds remaining(deferred.deadlineMs - now);
+            dispatch(deferred.req, deferred.callback, remaining, deferred.cost, deferred.session);
+        } catch (const std::exception& e) {
+            LOG_ERROR("[BNBBroker] Deferred request {} failed : {}", deferred.req.first, e.what());
+            deferred.callback(errorResponse(deferred.req.first, 503, TIMEOUT_ERROR_CODE, e.what()));
+        }
+    }
+}
 
-            stored_responses_[id] = std::move(json_data);
-            pending_requests_.erase(id);
+size_t BNBBroker::getPendingCount() {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    return pending_count_;
+}
 
-            LOG_INFO("[BNBBroker] Response stored for ID: {}", id);
-            response_cv_.notify_all();
-        } else {
-            LOG_WARNING("[BNBBroker] Received a message without an ID. Message: {}", payload);
+size_t BNBBroker::getDeferredCount() {
+    std::lock_guard<std::mutex> lock(deferred_mutex_);
+    return deferred_count_;
+}
+
+// Called with pending_mutex_ held, the callback is run by the caller once unlocked.
+// The timer belongs to the io thread of timerSession and is only cancelled from there,
+// from another session it fires later on an inactive slot and does nothing.
+BNBBroker::ResponseCallback BNBBroker::release(PendingRequest& pending, size_t session) {
+    ResponseCallback callback = std::move(pending.callback);
+    pending.callback = nullptr;
+    if (pending.timer) {
+        if (session == pending.timerSession || session == ANY_SESSION) {
+            pending.timer->cancel();
         }
+        pending.timer.reset();
     }
-    catch(const std::exception& e)
+    for (size_t index = 0; index < sessions_.size(); ++index) {
+        if (pending.sessions & (uint32_t{1} << index)) {
+            sessions_[index]->removeLoad();
+        }
+    }
+    pending.active = false;
+    pending.answeredId = pending.id;
+    --pending_count_;
+    return callback;
+}
+
+// Requests start probing at slot id % MAX_PENDING_REQUESTS, so most are found at once
+BNBBroker::PendingRequest* BNBBroker::findPending(uint64_t id) {
+    size_t slot = id % MAX_PENDING_REQUESTS;
+    for (size_t probe = 0; probe < MAX_PENDING_REQUESTS; ++probe) {
+        PendingRequest& pending = pending_[slot];
+        if (pending.active && pending.id == id) {
+            return &pending;
+        }
+        slot = (slot + 1) % MAX_PENDING_REQUESTS;
+    }
+    return nullptr;
+}
+
+bool BNBBroker::wasHedged(uint64_t id) const {
+    for (const PendingRequest& pending : pending_) {
+        if (!pending.active && pending.answeredId == id) {
+            return std::popcount(pending.sessions) > 1;
+        }
+    }
+    return false;
+}
+
+void BNBBroker::onTimeout(uint64_t id) {
+    ResponseCallback callback;
     {
-        LOG_ERROR("[BNBBroker] onMessage error: {}", e.what());
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        PendingRequest* pending = findPending(id);
+        if (!pending) {
+            return;
+        }
+        callback = release(*pending, pending->timerSession);
     }
+    LOG_WARNING("[BNBBroker] Request {} timed out", id);
+    callback(errorResponse(id, 408, TIMEOUT_ERROR_CODE, "Timeout waiting for response"));
 }
 
-std::string BNBBroker::loadPrivateKey(const std::string& keyPath) {
-    std::ifstream file(keyPath);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file: " + keyPath);
+void BNBBroker::failPending(const std::string& reason) {
+    std::vector<std::pair<uint64_t, ResponseCallback>> failed;
+    {
+        std::lock_guard<std::mutex> lock(deferred_mutex_);
+        if (drain_timer_) {
+            drain_timer_->cancel();
+            drain_timer_.reset();
+        }
+        drain_at_ms_ = NO_DRAIN;
+        for (auto& queue : deferred_) {
+            for (DeferredRequest& deferred : queue) {
+                failed.emplace_back(deferred.req.first, std::move(deferred.callback));
+            }
+            queue.clear();
+        }
+        deferred_count_ = 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        for (PendingRequest& pending : pending_) {
+            if (pending.active) {
+                failed.emplace_back(pending.id, release(pending, ANY_SESSION));
+            }
+        }
+    }
+    for (auto& [id, callback] : failed) {
+        callback(errorResponse(id, 408, TIMEOUT_ERROR_CODE, reason));
     }
+}
 
-    std::ostringstream key_content;
-    std::string line;
+nlohmann::json BNBBroker::errorResponse(uint64_t id, int status, int code, const std::string& msg) {
+    return {{"id", RequestsHelper::formatRequestId(id).view()}, {"status", status}, {"error", {{"code", code}, {"msg", msg}}}};
+}
 
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#' || line.find("----") != std::string::npos) {
-            continue;
+uint64_t BNBBroker::nowMs() {
+    return Clock::now() / 1000000;
+}
+
+// 429 warns before a ban, 418 is the ban itself, both say when requests are accepted again
+void BNBBroker::onRateLimited(const nlohmann::json& response, uint64_t now) {
+    uint64_t retryAfter = now + 60 * 1000;
+    auto error = response.find("error");
+    if (error != response.end() && error->contains("data")) {
+        retryAfter = (*error)["data"].value("retryAfter", retryAfter);
+    }
+    rateLimiter_.blockUntil(retryAfter);
+    LOG_ERROR("[BNBBroker] Rate limit exceeded (status {}), requests blocked for {} ms : {}", response.value("status", 0), retryAfter - std::min(retryAfter, now), rateLimiter_.describe(now));
+}
+
+// A reconnected session logs on again once the broker started, until then its requests are signed
+void BNBBroker::onSessionUp(BNBBrokerSession& session) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    sessions_cv_.notify_all();
+    updateAuthentication();
+    if (!relogIn_) {
+        return;
+    }
+    try {
+        if (logOn(session, nullptr)) {
+            LOG_INFO("[BNBBroker] Logging in reconnected session {} ...", session.getName());
         }
-        key_content << line << '\n';  // Append the valid lines to the result
+    } catch (const std::exception& e) {
+        LOG_ERROR("[BNBBroker] Session {} logon not sent, its requests stay signed : {}", session.getName(), e.what());
     }
+}
 
-    return key_content.str();
-}
\ No newline at end of file
+// A new connection has to log on again, its requests in flight time out
+void BNBBroker::onSessionDown(BNBBrokerSession& session) {
+    LOG_WARNING("[BNBBroker] Session {} down, {} requests in flight", session.getName(), session.getLoad());
+    if (session.isLoggedIn()) {
+        session.setLoggedIn(false);
+        LOG_WARNING("[BNBBroker] Session {} lost its logon, its requests are signed until it logs on again", session.getName());
+    }
+    updateAuthentication();
+}
+
+void BNBBroker::onSessionMessage(BNBBrokerSession& session, const std::string& payload) {
+    try
+    {
+        auto json_data = nlohmann::json::parse(payload);
+
+        uint64_t now = nowMs();
+        auto rateLimits = json_data.find("rateLimits");
+        if (rateLimits != json_data.end()) {
+            rateLimiter_.update(*rateLimits, now);
+        }
+        int status = json_data.value("status", -1);
+        if (status == 429 || status == 418) {
+            onRateLimited(json_data, now);
+        }
+
+        auto idField = json_data.find("id");
+        uint64_t id = 0;
+        if (idField == json_data.end() || !idField->is_string() || !RequestsHelper::parseRequestId(idField->get_ref<const std::string&>(), id)) {
+            LOG_WARNING("[BNBBroker] Received a message without a request ID of this session. Message: {}", payload);
+            return;
+        }
+
+        ResponseCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            PendingRequest* pending = findPending(id);
+            if (!pending) {
+                if (wasHedged(id)) {
+                    LOG_DEBUG("[BNBBroker] Hedged copy of request {} answered on session {} after the first one", id, session.getName());
+                } else {
+                    LOG_WARNING("[BNBBroker] Response for unknown or timed out request ID: {}", id);
+                }
+                return;
+            }
+            callback = release(*pending, session.getIndex());
+        }
+        if (json_data.contains("error")) {
+            int errorCode = json_data["error"].value("code", 0);
+            std::string errorMsg = json_data["error"].value("msg", "Unknown error");
+            LOG_ERROR("[BNBBroker] Error received for message id {} : Status: {}, Code: {}, Message: {}", id, status, errorCode, errorMsg);
+        }
+        callback(std::move(json_data));
+    }
+    catch(const std::exception& e)
+    {
+        LOG_ERROR("[BNBBroker] onMessage error: {}", e.what());
+    }
+}
@@ -0,0 +1,85 @@
+#include "bnb/marketConnection/BNBBrokerSession.h"
+#include "bnb/marketConnection/BNBBroker.h"
+#include "common/logger.hpp"
+
+#include <algorithm>
+
+BNBBrokerSession::BNBBrokerSession(BNBBroker& broker, size_t index, SessionRole role, const std::string& uri,
+                                   std::chrono::milliseconds reconnectBackoff, std::chrono::milliseconds maxReconnectBackoff) :
+    broker_(broker),
+    index_(index),
+    role_(role),
+    name_(std::string(role == SessionRole::ORDERS ? "orders-" : "queries-") + std::to_string(index)),
+    uri_(uri),
+    backoff_(reconnectBackoff),
+    max_backoff_(maxReconnectBackoff) {
+}
+
+BNBBrokerSession::~BNBBrokerSession() {
+    stop();
+}
+
+void BNBBrokerSession::start() {
+    running_ = true;
+    attempts_ = 0;
+    WebSocketListener::resetClient();
+    WebSocketListener::keepRunning();
+    ws_thread_ = std::thread([this]() {
+        connect(uri_);
+        WebSocketListener::startClient();
+    });
+}
+
+void BNBBrokerSession::stop() {
+    if (running_) {
+        running_ = false;
+        WebSocketListener::stopClient();
+        if (ws_thread_.joinable()) {
+            ws_thread_.join();
+        }
+        reconnect_timer_.reset();
+    }
+}
+
+void BNBBrokerSession::onOpen(websocketpp::connection_hdl hdl) {
+    WebSocketListener::onOpen(hdl);
+    attempts_ = 0;
+    connection_.fetch_add(1, std::memory_order_acq_rel);
+    up_.store(true, std::memory_order_release);
+    LOG_INFO("[BNBBroker][SESSION {}] Connected", name_);
+    broker_.onSessionUp(*this);
+}
+
+void BNBBrokerSession::onMessage(websocketpp::connection_hdl hdl, wsppclient::message_ptr msg) {
+    broker_.onSessionMessage(*this, msg->get_payload());
+}
+
+void BNBBrokerSession::onClose(websocketpp::connection_hdl hdl) {
+    WebSocketListener::onClose(hdl);
+    onDown();
+}
+
+void BNBBrokerSession::onFail(websocketpp::connection_hdl hdl) {
+    WebSocketListener::onFail(hdl);
+    onDown();
+}
+
+void BNBBrokerSession::onDown() {
+    up_.store(false, std::memory_order_release);
+    broker_.onSessionDown(*this);
+    scheduleReconnect();
+}
+
+// The failed connection calls onFail again, which schedules the next attempt
+void BNBBrokerSession::scheduleReconnect() {
+    if (!running_) {
+        return;
+    }
+    auto delay = std::min(max_backoff_, backoff_ * (1u << std::min<uint32_t>(attempts_++, 16)));
+    LOG_WARNING("[BNBBroker][SESSION {}] Reconnect attempt {} in {} ms", name_, attempts_, delay.count());
+    reconnect_timer_ = setTimer(delay.count(), [this](const websocketpp::lib::error_code& ec) {
+        if (!ec && running_) {
+            connect(uri_);
+        }
+    });
+}
@@ -1,12 +1,81 @@
 #include "bnb/marketConnection/BNBFeeder.h"
 #include "common/logger.hpp"
 
+namespace {
+    // Exchange sequence used to order copies of the same update across connections.
+    inline uint64_t sequenceOf(const BookTickerMDFrame& frame) { return frame.updateId; }
+    inline uint64_t sequenceOf(const AggTradeMDFrame& frame) { return frame.tradeId; }
+    inline uint64_t sequenceOf(const KlineMDFrame& frame) { return frame.exchangeTime; }
+    // Chunks of one depth event share the update ids
+    inline uint64_t sequenceOf(const DepthMDFrame& frame) { return frame.finalUpdateId * DepthMDFrame::MAX_CHUNKS + frame.chunk; }
+    template <typename... Frames>
+    uint64_t sequenceOf(const std::variant<Frames...>& frame) {
+        return std::visit([](const auto& alternative) { return sequenceOf(alternative); }, frame);
+    }
+
+    // Combined stream envelopes are only sent on the /stream endpoint
+    std::string combinedEndpoint(const std::string& uri) {
+        const std::string raw = "/ws";
+        if (uri.size() >= raw.size() && uri.compare(uri.size() - raw.size(), raw.size(), raw) == 0) {
+            return uri.substr(0, uri.size() - raw.size()) + "/stream";
+        }
+        return uri;
+    }
+}
+
 template <typename StreamType>
 BNBFeeder<StreamType>::BNBFeeder(const BNBMarketConnectionConfig& config) : 
-    frunning_(false), 
-    uri_(config.streamsWsEndpoint), 
     maxStreamsSubs_(config.maxStreamsSubs), 
-    wsPersistConnection_(config.wsPersistConnection) {
+    shards_(config.feederShards),
+    legs_(config.feederRedundantLegs ? 2 : 1),
+    delivery_mode_(config.feederDeliveryMode),
+    wsPersistConnection_(config.wsPersistConnection),
+    frunning_(false), 
+    queue_waiter_(config.feederWaitStrategy),
+    leg_wins_(std::make_unique<std::atomic<uint64_t>[]>(legs_)),
+    backoff_(config.wsReconnectBackoffMs),
+    max_backoff_(config.wsReconnectMaxBackoffMs),
+    reconnect_timeout_(config.wsReconnectTimeoutMs),
+    max_connection_age_(config.wsMaxConnectionAgeS),
+    resync_queue_(config.feederQueueCapacity) {
+    if (shards_ == 0) {
+        throw std::runtime_error("[FEEDER] feeder_shards must be at least 1.");
+    }
+    if (Streams::HAS_DEPTH && delivery_mode_ == DeliveryMode::CONFLATE) {
+        throw std::runtime_error("[FEEDER] Depth diffs cannot be conflated, use feeder_delivery_mode = QUEUE.");
+    }
+    // Connections are laid out leg by leg, slot = leg * shards + shard
+    for (size_t leg = 0; leg < legs_; ++leg) {
+        for (size_t shard = 0; shard < shards_; ++shard) {
+            size_t slot = slot_names_.size();
+            slot_names_.push_back(std::to_string(shard) + (legs_ > 1 ? std::string(1, static_cast<char>('A' + leg)) : ""));
+            slot_uris_.push_back((leg == 0) ? config.streamsWsEndpoint : config.streamsWsEndpointB);
+            if (Streams::COUNT > 1) {
+                slot_uris_.back() = combinedEndpoint(slot_uris_.back());
+            }
+            WebSocketOptions options = config.wsOptions;
+            options.cpu = (slot < config.feederBusyPollCpus.size()) ? config.feederBusyPollCpus[slot] : -1;
+            if (options.busyPoll && options.cpu < 0) {
+                LOG_WARNING("[FEEDER] Busy polling connection {} without a dedicated cpu, list one more core in feeder_busy_poll_cpus", slot_names_.back());
+            }
+            slot_options_.push_back(options);
+            connections_.push_back(makeConnection(slot, 2 * slot, 0));
+            if (delivery_mode_ == DeliveryMode::QUEUE) {
+                update_queues_.push_back(std::make_unique<SPSCQueue<StreamType>>(config.feederQueueCapacity));
+                update_queues_.push_back(std::make_unique<SPSCQueue<StreamType>>(config.feederQueueCapacity));
+            }
+        }
+    }
+    size_t slots = connections_.size();
+    slot_streams_.resize(slots);
+    slot_instruments_.resize(slots);
+    retired_updates_.assign(slots, 0);
+    lost_.assign(slots, false);
+    generations_.assign(slots, 0);
+    attempts_.assign(slots, 0);
+    next_attempts_.resize(slots);
+    connected_at_.resize(slots);
+    replacements_.resize(slots);
 }
 
 template <typename StreamType>
@@ -14,210 +83,556 @@ BNBFeeder<StreamType>::~BNBFeeder() {
     stop();
 }
 
+template <typename StreamType>
+std::unique_ptr<BNBStreamConnection<StreamType>> BNBFeeder<StreamType>::makeConnection(size_t slot, size_t queue, uint64_t generation) {
+    auto connection = std::make_unique<BNBStreamConnection<StreamType>>(*this, slot, queue, generation, slot_names_[slot], slot_uris_[slot], maxStreamsSubs_);
+    connection->setOptions(slot_options_[slot]);
+    return connection;
+}
+
+template <typename StreamType>
+void BNBFeeder<StreamType>::setInstrumentRegistry(const InstrumentRegistry& registry) {
+    if (subscribed_) {
+        throw std::runtime_error("[FEEDER] Instrument registry cannot be replaced once subscribed, connections publish into its state.");
+    }
+    registry_ = &registry;
+    size_t keys = registry_->size() * Streams::COUNT;
+    last_published_ = std::make_unique<std::atomic<uint64_t>[]>(keys);
+    last_delivered_.assign(keys, 0);
+    stale_ = std::make_unique<std::atomic<bool>[]>(registry_->size());
+    if (delivery_mode_ == DeliveryMode::CONFLATE) {
+        mailbox_ = std::make_unique<ConflatingMailbox<StreamType>>(keys, 2 * connections_.size());
+    }
+}
+
 template <typename StreamType>
 void BNBFeeder<StreamType>::start() {
-    fws_thread_ = std::thread([this]() {
-        frunning_= true;
-        connect(uri_);
-        WebSocketListener::startClient();
-    });
+    queue_waiter_.open();
+    frunning_ = true;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        for (auto& connection : connections_) {
+            connection->start();
+        }
+    }
+    std::fill(connected_at_.begin(), connected_at_.end(), std::chrono::steady_clock::now());
+    if (wsPersistConnection_) {
+        supervisor_thread_ = std::thread([this]() { supervise(); });
+    }
 }
 
 template <typename StreamType>
 void BNBFeeder<StreamType>::stop() {
-    if (frunning_) {
+    {
+        std::lock_guard<std::mutex> lock(supervisor_mutex_);
         frunning_ = false;
-        WebSocketListener::stopClient();
-        if (fws_thread_.joinable()) {
-            fws_thread_.join();
+    }
+    supervisor_cv_.notify_all();
+    if (supervisor_thread_.joinable()) {
+        supervisor_thread_.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        for (auto& connection : connections_) {
+            connection->stop();
         }
     }
+    queue_waiter_.close();
 }
 
+// Called from the io thread of the connection, only flags the slot.
 template <typename StreamType>
-void BNBFeeder<StreamType>::onMessage(websocketpp::connection_hdl hdl, websocketpp::client<websocketpp::config::asio_client>::message_ptr msg) {
-    try {
-        std::string payload = msg->get_payload();
-        LOG_DEBUG("[FEEDER] onMessage: {}", payload);
-
-        auto json_data = nlohmann::json::parse(payload);
-
-        // Check if the message contains an error object
-        if (json_data.contains("error")) {
-            auto error_data = json_data["error"];
-            int error_code = error_data.value("code", 0);
-            std::string error_msg = error_data.value("msg", "Unknown error");
+void BNBFeeder<StreamType>::onConnectionLost(size_t slot, uint64_t generation) {
+    if (!wsPersistConnection_) {
+        LOG_WARNING("[FEEDER][CONN {}] Connection lost, ws_persist_connection is off so it will not be replaced.", slot_names_[slot]);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(supervisor_mutex_);
+    if (generations_[slot] != generation || lost_[slot]) {
+        return;
+    }
+    LOG_WARNING("[FEEDER][CONN {}] Connection lost, scheduling reconnect.", slot_names_[slot]);
+    lost_[slot] = true;
+    attempts_[slot] = 0;
+    next_attempts_[slot] = std::chrono::steady_clock::now();
+    supervisor_cv_.notify_one();
+}
 
-            LOG_ERROR("[FEEDER] Error received - Code: {}, Message: {}", error_code, error_msg);
+// Slots are replaced concurrently: each tick starts the replacements due and polls
+// the ones in progress, a slow handshake never holds up the other slots.
+template <typename StreamType>
+void BNBFeeder<StreamType>::supervise() {
+    std::unique_lock<std::mutex> lock(supervisor_mutex_);
+    while (frunning_) {
+        bool replacing = std::any_of(replacements_.begin(), replacements_.end(), [](const Replacement& r) { return r.connection != nullptr; });
+        supervisor_cv_.wait_for(lock, std::chrono::milliseconds(replacing ? 1 : 100));
+        for (size_t slot = 0; slot < lost_.size() && frunning_; ++slot) {
+            auto now = std::chrono::steady_clock::now();
+            bool lost = lost_[slot];
+            Replacement& replacement = replacements_[slot];
+            if (replacement.connection == nullptr) {
+                bool rotate = !lost && max_connection_age_.count() > 0 && now - connected_at_[slot] >= max_connection_age_;
+                if ((lost && now >= next_attempts_[slot]) || rotate) {
+                    lock.unlock();
+                    beginReplacement(slot, lost);
+                    lock.lock();
+                }
+                continue;
+            }
 
-            // If the message has an ID, log that too
-            if (json_data.contains("id")) {
-                int message_id = json_data["id"];
-                LOG_ERROR("[FEEDER] Error associated with message ID: {}", message_id);
+            lock.unlock();
+            if (lost && !replacement.lost) {
+                // The connection being rotated dropped before its replacement was ready
+                replacement.lost = true;
+                replacement.staleInstruments = markStale(slot);
             }
+            ReplacementState state = pollReplacement(slot);
+            lock.lock();
 
-            return;  // Early return since this was an error message
+            now = std::chrono::steady_clock::now();
+            if (state == ReplacementState::PENDING) {
+                continue;
+            }
+            if (state == ReplacementState::REPLACED) {
+                lost_[slot] = false;
+                attempts_[slot] = 0;
+                connected_at_[slot] = now;
+                continue;
+            }
+            auto delay = std::min(max_backoff_, backoff_ * (1u << std::min<uint32_t>(attempts_[slot]++, 16)));
+            LOG_WARNING("[FEEDER][CONN {}] Reconnect attempt {} failed, next one in {} ms", slot_names_[slot], attempts_[slot], delay.count());
+            if (lost_[slot]) {
+                next_attempts_[slot] = now + delay;
+            } else {
+                // Failed rotation, the current connection is still up, retry later
+                connected_at_[slot] = now - max_connection_age_ + std::chrono::duration_cast<std::chrono::seconds>(delay) + std::chrono::seconds(1);
+            }
+        }
+    }
+    lock.unlock();
+    for (Replacement& replacement : replacements_) {
+        if (replacement.connection) {
+            replacement.connection->stop();
+            replacement.connection.reset();
         }
+    }
+}
 
-        // Check if the message is a response to a request
-        if (json_data.contains("id")) {
-            int message_id = json_data["id"];
-            if (pending_requests_.count(message_id)) {
-                pending_requests_.erase(message_id);
-                LOG_INFO("[FEEDER] Subscription confirmed for message ID: {}", message_id);
+// Make before break: the replacement is subscribed before the old connection
+// is stopped. Runs on the supervisor thread, never on an io thread.
+template <typename StreamType>
+void BNBFeeder<StreamType>::beginReplacement(size_t slot, bool lost) {
+    Replacement& replacement = replacements_[slot];
+    replacement.startTime = Clock::now();
+    replacement.lost = lost;
+    replacement.staleInstruments.clear();
+    if (lost) {
+        replacement.staleInstruments = markStale(slot);
+    }
 
-                // Additional processing for the response if needed
-                if (json_data.contains("result") && json_data["result"].is_null()) {
-                    LOG_INFO("[FEEDER] Subscription to stream was successful.");
-                } else {
-                    LOG_WARNING("[FEEDER] Unexpected result in subscription response: {}", payload);
-                }
+    size_t queue;
+    std::vector<std::string> streams;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        queue = connections_[slot]->getQueue() ^ 1;
+        streams = slot_streams_[slot];
+    }
+    {
+        std::lock_guard<std::mutex> lock(supervisor_mutex_);
+        replacement.generation = generations_[slot] + 1;
+    }
+    LOG_INFO("[FEEDER][CONN {}] {} connection, {} instruments marked stale", slot_names_[slot], lost ? "Replacing lost" : "Rotating", replacement.staleInstruments.size());
 
-                return;  // Early return since this was a response, not market data
-            }
+    replacement.connection = makeConnection(slot, queue, replacement.generation);
+    replacement.connection->subscribe(streams);
+    replacement.connection->start();
+    replacement.deadline = std::chrono::steady_clock::now() + reconnect_timeout_;
+}
+
+template <typename StreamType>
+typename BNBFeeder<StreamType>::ReplacementState BNBFeeder<StreamType>::pollReplacement(size_t slot) {
+    Replacement& replacement = replacements_[slot];
+    if (!replacement.connection->isSubscribed()) {
+        if (!replacement.connection->isDown() && frunning_ && std::chrono::steady_clock::now() < replacement.deadline) {
+            return ReplacementState::PENDING;
         }
+        replacement.connection->stop();
+        replacement.connection.reset();
+        failed_reconnects_.fetch_add(1, std::memory_order_relaxed);
+        return ReplacementState::FAILED;
+    }
+
+    std::unique_ptr<BNBStreamConnection<StreamType>> previous;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        previous = std::move(connections_[slot]);
+        connections_[slot] = std::move(replacement.connection);
+    }
+    {
+        std::lock_guard<std::mutex> lock(supervisor_mutex_);
+        generations_[slot] = replacement.generation;
+    }
+    previous->stop();
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        retired_updates_[slot] += previous->getUpdatesCount();
+        retired_poll_iterations_ += previous->getPollIterations();
+        retired_poll_idle_iterations_ += previous->getPollIdleIterations();
+    }
+
+    reconnects_.fetch_add(1, std::memory_order_relaxed);
+    reconnect_latency_.record(replacement.startTime, Clock::now());
+    LOG_INFO("[FEEDER][CONN {}] Replacement connection subscribed after {} us", slot_names_[slot], (Clock::now() - replacement.startTime) / 1000);
 
-        // If the message is not a response or an error, it's likely market data
-        StreamType dataFrame = parseData(json_data);
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            update_queue_.push(dataFrame);
+    if (!replacement.staleInstruments.empty()) {
+        resync(replacement.staleInstruments);
+    }
+    return ReplacementState::REPLACED;
+}
+
+// Instruments of the slot are only stale if no other leg still streams them.
+template <typename StreamType>
+std::vector<InstrumentId> BNBFeeder<StreamType>::markStale(size_t slot) {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    for (size_t leg = 0; leg < legs_; ++leg) {
+        size_t other = leg * shards_ + slot % shards_;
+        if (other != slot && !connections_[other]->isDown()) {
+            return {};
         }
-        queue_cv_.notify_one();
+    }
+    for (InstrumentId instrument : slot_instruments_[slot]) {
+        stale_[instrument].store(true, std::memory_order_relaxed);
+    }
+    return slot_instruments_[slot];
+}
+
+// The snapshot is requested asynchronously, the supervisor goes on with the other slots
+template <typename StreamType>
+void BNBFeeder<StreamType>::resync(const std::vector<InstrumentId>& instruments) {
+    if (!snapshot_provider_) {
+        return;
+    }
+    size_t requested = instruments.size();
+    try {
+        snapshot_provider_(instruments, [this, requested](std::vector<StreamType> snapshot) { onSnapshot(requested, std::move(snapshot)); });
     } catch (const std::exception& e) {
-        LOG_ERROR("[FEEDER] onMessage error: {}", e.what());
+        LOG_ERROR("[FEEDER] Snapshot resync failed, instruments stay stale until their next update: {}", e.what());
     }
 }
 
+// Any thread, several snapshots may complete at once
 template <typename StreamType>
-void BNBFeeder<StreamType>::onClose(websocketpp::connection_hdl hdl) {
-    WebSocketListener::onClose(hdl);
-    if (wsPersistConnection_)
+void BNBFeeder<StreamType>::onSnapshot(size_t requested, std::vector<StreamType> snapshot) {
+    if (!frunning_) {
+        return;
+    }
+    size_t pushed = 0;
     {
-        stop();
-        start();
-        subscribeToTickers(subscription_list_);
+        std::lock_guard<std::mutex> lock(resync_mutex_);
+        for (auto& dataFrame : snapshot) {
+            MarketDataFrame& header = Streams::header(dataFrame);
+            if (header.instrumentId == INVALID_INSTRUMENT_ID || !stale_[header.instrumentId].load(std::memory_order_relaxed)) {
+                continue;
+            }
+            header.receiveTime = Clock::now();
+            header.parseTime = header.receiveTime;
+            if (!resync_queue_.tryPush(dataFrame)) {
+                LOG_WARNING("[FEEDER] Resync queue full, remaining instruments stay stale until their next update.");
+                break;
+            }
+            ++pushed;
+        }
     }
+    LOG_INFO("[FEEDER] Resynchronised {} of {} stale instruments from snapshot", pushed, requested);
+    queue_waiter_.notify();
 }
 
 template <typename StreamType>
-void BNBFeeder<StreamType>::onFail(websocketpp::connection_hdl hdl) {
-    WebSocketListener::onFail(hdl);
-    if (wsPersistConnection_)
-    {
-        stop();
-        start();
-        subscribeToTickers(subscription_list_);
+bool BNBFeeder<StreamType>::arbitrate(size_t slot, const StreamType& dataFrame) {
+    uint64_t sequence = sequenceOf(dataFrame);
+    std::atomic<uint64_t>& last = last_published_[keyOf(dataFrame)];
+    uint64_t current = last.load(std::memory_order_relaxed);
+    do {
+        if (sequence <= current) {
+            duplicates_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!last.compare_exchange_weak(current, sequence, std::memory_order_relaxed));
+    leg_wins_[slot / shards_].fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <typename StreamType>
+void BNBFeeder<StreamType>::publish(size_t slot, size_t queue, StreamType&& dataFrame) {
+    if (!arbitrate(slot, dataFrame)) {
+        return;
+    }
+    const MarketDataFrame& header = Streams::header(dataFrame);
+    if (header.exchangeTime != 0) {
+        feed_latency_.record(header.exchangeTime * 1000000, header.receiveTime + ExchangeClock::offset());
     }
+    parse_latency_.record(header.receiveTime, header.parseTime);
+    if (delivery_mode_ == DeliveryMode::CONFLATE) {
+        auto newer = [](const StreamType& current, const StreamType& incoming) { return sequenceOf(incoming) > sequenceOf(current); };
+        if (mailbox_->publish(queue, keyOf(dataFrame), dataFrame, newer)) {
+            queue_waiter_.notify();
+        }
+        return;
+    }
+    SPSCQueue<StreamType>& updateQueue = *update_queues_[queue];
+    if (!updateQueue.tryPush(std::move(dataFrame))) {
+        // Consumer is lagging, hold the socket rather than dropping ticks.
+        LOG_WARNING("[FEEDER][CONN {}] Update queue full ({} frames), waiting for consumer.", slot_names_[slot], updateQueue.capacity());
+        while (!updateQueue.tryPush(std::move(dataFrame))) {
+            if (!frunning_) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+    queue_waiter_.notify();
 }
 
+// Snapshot frames are only delivered if no live update beat them.
+template <typename StreamType>
+bool BNBFeeder<StreamType>::popResync(StreamType& dataFrame) {
+    while (resync_queue_.tryPop(dataFrame)) {
+        if (stale_[Streams::header(dataFrame).instrumentId].exchange(false, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
 
+// Live frames, a delivered update also ends the staleness of its instrument.
 template <typename StreamType>
-StreamType BNBFeeder<StreamType>::getUpdate() {
-    std::unique_lock<std::mutex> lock(queue_mutex_);
-    queue_cv_.wait(lock, [this] { return !update_queue_.empty() || !frunning_; });
+bool BNBFeeder<StreamType>::accept(const StreamType& dataFrame) {
+    if (!inOrder(dataFrame)) {
+        return false;
+    }
+    std::atomic<bool>& stale = stale_[Streams::header(dataFrame).instrumentId];
+    if (stale.load(std::memory_order_relaxed)) {
+        stale.store(false, std::memory_order_relaxed);
+    }
+    return true;
+}
 
-    if (!frunning_ && update_queue_.empty()) {
+// Queues are polled round robin so a busy shard cannot starve the others.
+template <typename StreamType>
+StreamType BNBFeeder<StreamType>::getUpdate() {
+    StreamType dataFrame;
+    auto tryPop = [this, &dataFrame] {
+        if (popResync(dataFrame)) {
+            return true;
+        }
+        if (delivery_mode_ == DeliveryMode::CONFLATE) {
+            return mailbox_ && mailbox_->tryPop(dataFrame) && accept(dataFrame);
+        }
+        for (size_t i = 0; i < update_queues_.size(); ++i) {
+            size_t queue = next_queue_;
+            next_queue_ = (next_queue_ + 1 == update_queues_.size()) ? 0 : next_queue_ + 1;
+            if (update_queues_[queue]->tryPop(dataFrame) && accept(dataFrame)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    if (!queue_waiter_.wait(tryPop)) {
         throw std::runtime_error("No more updates, feeder stopped.");
     }
-
-    StreamType dataFrame = update_queue_.front();
-    update_queue_.pop();
+    onDequeue(dataFrame, Clock::now());
     return dataFrame;
 }
 
+// Blocks until at least one frame is available, then hands out everything
+// already queued (up to max) in one go.
 template <typename StreamType>
-int BNBFeeder<StreamType>::subscribeToTickers(const std::vector<std::string>& symbols) {
-    {
-        std::unique_lock<std::mutex> lock(connection_mutex_);
-        connection_cv_.wait(lock, [this] { return is_connected_; });
+bool BNBFeeder<StreamType>::popBatch(std::vector<StreamType>& out, size_t max) {
+    StreamType snapshotFrame;
+    while (out.size() < max && popResync(snapshotFrame)) {
+        out.push_back(snapshotFrame);
     }
-    LOG_INFO("[FEEDER] Subscribing to {} tickers ", symbols.size());
-    subscription_list_=symbols;
+    auto rejected = [this](const StreamType& dataFrame) { return !accept(dataFrame); };
+    if (delivery_mode_ == DeliveryMode::CONFLATE) {
+        if (!mailbox_) {
+            return !out.empty();
+        }
+        size_t first = out.size();
+        mailbox_->drain(out, max - out.size());
+        out.erase(std::remove_if(out.begin() + first, out.end(), rejected), out.end());
+        return !out.empty();
+    }
+    for (size_t i = 0; i < update_queues_.size() && out.size() < max; ++i) {
+        size_t queue = next_queue_;
+        next_queue_ = (next_queue_ + 1 == update_queues_.size()) ? 0 : next_queue_ + 1;
+        size_t first = out.size();
+        update_queues_[queue]->tryPopMany(out, max - out.size());
+        out.erase(std::remove_if(out.begin() + first, out.end(), rejected), out.end());
+    }
+    return !out.empty();
+}
 
-    std::string streamName = getStreamName();
-    std::vector<std::string> streams;
-    int currentSize=0;
-    for (const auto& symbol : symbols) {
-        std::string lowercase_symbol = symbol;
-        std::transform(lowercase_symbol.begin(), lowercase_symbol.end(), lowercase_symbol.begin(), ::tolower);
-        streams.push_back(lowercase_symbol + "@" + streamName);
-        if(++currentSize==maxStreamsSubs_)
-        {
-            LOG_WARNING("[FEEDER] Subscripion size is higher than maximum allowed {} vs max {}", symbols.size(), maxStreamsSubs_);
-            break;
+template <typename StreamType>
+size_t BNBFeeder<StreamType>::drain(std::vector<StreamType>& out, size_t max) {
+    out.clear();
+    if (!queue_waiter_.wait([this, &out, max] { return popBatch(out, max); })) {
+        throw std::runtime_error("No more updates, feeder stopped.");
+    }
+    // One timestamp for the whole batch, it left the queues at once
+    uint64_t dequeueTime = Clock::now();
+    for (auto& dataFrame : out) {
+        onDequeue(dataFrame, dequeueTime);
+    }
+    return out.size();
+}
+
+template <typename StreamType>
+size_t BNBFeeder<StreamType>::poll(std::vector<StreamType>& out, size_t max) {
+    out.clear();
+    if (popBatch(out, max)) {
+        uint64_t dequeueTime = Clock::now();
+        for (auto& dataFrame : out) {
+            onDequeue(dataFrame, dequeueTime);
         }
     }
+    return out.size();
+}
 
-    size_t chunk_size = maxStreamsSubs_/4;
-    for (size_t i = 0; i < streams.size(); i += chunk_size) {
-        std::vector<std::string> chunk(streams.begin() + i, streams.begin() + std::min(streams.size(), i + chunk_size));
+template <typename StreamType>
+void BNBFeeder<StreamType>::onDequeue(StreamType& dataFrame, uint64_t dequeueTime) {
+    MarketDataFrame& header = Streams::header(dataFrame);
+    header.dequeueTime = dequeueTime;
+    queue_latency_.record(header.parseTime, dequeueTime);
+}
 
-        int request_id = next_request_id_++;
-        nlohmann::json request;
-        request["method"] = "SUBSCRIBE";
-        request["params"] = chunk;
-        request["id"] = request_id;
+// Frames won on different queues (legs, rotated connection) may interleave, keep them ordered
+template <typename StreamType>
+bool BNBFeeder<StreamType>::inOrder(const StreamType& dataFrame) {
+    uint64_t& last = last_delivered_[keyOf(dataFrame)];
+    uint64_t sequence = sequenceOf(dataFrame);
+    if (sequence > last) {
+        last = sequence;
+        return true;
+    }
+    duplicates_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
 
-        std::string request_str = request.dump();
-        writeWS(request_str);
-        pending_requests_.insert(request_id);
+template <typename StreamType>
+std::vector<uint64_t> BNBFeeder<StreamType>::getShardUpdateCounts() const {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    std::vector<uint64_t> counts(shards_, 0);
+    for (size_t slot = 0; slot < connections_.size(); ++slot) {
+        counts[slot % shards_] += retired_updates_[slot] + connections_[slot]->getUpdatesCount();
+    }
+    return counts;
+}
 
-//        LOG_INFO("Subscription request sent for symbols (chunk {} - {}): {} with request ID: {}",
-  //                   i + 1, std::min(i + chunk_size, streams.size()), fmt::join(chunk, ", "), request_id);
+template <typename StreamType>
+uint64_t BNBFeeder<StreamType>::getPollIterations() const {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    uint64_t iterations = retired_poll_iterations_;
+    for (const auto& connection : connections_) {
+        iterations += connection->getPollIterations();
     }
-    return currentSize;
+    return iterations;
 }
 
+template <typename StreamType>
+uint64_t BNBFeeder<StreamType>::getPollIdleIterations() const {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    uint64_t idle = retired_poll_idle_iterations_;
+    for (const auto& connection : connections_) {
+        idle += connection->getPollIdleIterations();
+    }
+    return idle;
+}
 
 template <typename StreamType>
-std::string BNBFeeder<StreamType>::getStreamName() {
-    if constexpr (std::is_same_v<StreamType, BookTickerMDFrame>) {
-        return "bookTicker";
-    } else if constexpr (std::is_same_v<StreamType, KlineMDFrame>) {
-        return "kline_1m";  // Assuming 1-minute kline stream, adjust as needed
-    } else if constexpr (std::is_same_v<StreamType, AggTradeMDFrame>) {
-        return "aggTrade";
-    } else {
-        throw std::runtime_error("Unknown stream type");
-    }
-}
-
-// Template specializations
-template <>
-BookTickerMDFrame BNBFeeder<BookTickerMDFrame>::parseData(const nlohmann::json& json_data) {
-    BookTickerMDFrame dataFrame;
-    dataFrame.symbol = json_data["s"];
-    dataFrame.bestBidPrice = std::stod(json_data["b"].get<std::string>());
-    dataFrame.bestBidQty = std::stod(json_data["B"].get<std::string>());
-    dataFrame.bestAskPrice = std::stod(json_data["a"].get<std::string>());
-    dataFrame.bestAskQty = std::stod(json_data["A"].get<std::string>());
-    return dataFrame;
+std::vector<uint64_t> BNBFeeder<StreamType>::getLegWinCounts() const {
+    std::vector<uint64_t> counts;
+    for (size_t leg = 0; leg < legs_; ++leg) {
+        counts.push_back(leg_wins_[leg].load(std::memory_order_relaxed));
+    }
+    return counts;
 }
 
-template <>
-KlineMDFrame BNBFeeder<KlineMDFrame>::parseData(const nlohmann::json& json_data) {
-    KlineMDFrame dataFrame;
-    dataFrame.symbol = json_data["s"];
-    dataFrame.open = json_data["o"];
-    dataFrame.high = json_data["h"];
-    dataFrame.low = json_data["l"];
-    dataFrame.close = json_data["c"];
-    dataFrame.volume = json_data["v"];
-    return dataFrame;
+template <typename StreamType>
+int BNBFeeder<StreamType>::subscribeToTickers(const std::vector<std::string>& symbols) {
+    if (registry_ == nullptr) {
+        throw std::runtime_error("[FEEDER] Instrument registry must be set before subscribing.");
+    }
+    if (subscribed_.exchange(true)) {
+        throw std::runtime_error("[FEEDER] Already subscribed, a feeder subscribes once.");
+    }
+    LOG_INFO("[FEEDER] Subscribing to {} tickers over {} shards x {} legs", symbols.size(), shards_, legs_);
+    std::vector<std::string_view> streamNames = Streams::names();
+    size_t maxSymbols = maxStreamsSubs_ / streamNames.size() * shards_;
+    if (symbols.size() > maxSymbols) {
+        LOG_WARNING("[FEEDER] Subscripion size is higher than maximum allowed {} vs max {} ({} streams per connection), increase feeder_shards", symbols.size(), maxSymbols, maxStreamsSubs_);
+    }
+
+    std::vector<std::string> lowercaseSymbols;
+    std::vector<InstrumentId> instruments;
+    for (const auto& symbol : symbols) {
+        if (lowercaseSymbols.size() == maxSymbols) {
+            break;
+        }
+        std::string lowercase_symbol = symbol;
+        std::transform(lowercase_symbol.begin(), lowercase_symbol.end(), lowercase_symbol.begin(), ::tolower);
+        lowercaseSymbols.push_back(lowercase_symbol);
+        std::string uppercase_symbol = symbol;
+        std::transform(uppercase_symbol.begin(), uppercase_symbol.end(), uppercase_symbol.begin(), ::toupper);
+        instruments.push_back(registry_->find(uppercase_symbol));
+    }
+
+    // Even split by symbol, so every connection carries a similar message rate and
+    // all the streams of a symbol share a connection (and stay ordered between them)
+    size_t offset = 0;
+    size_t streamCount = 0;
+    for (size_t shard = 0; shard < shards_; ++shard) {
+        size_t count = lowercaseSymbols.size() / shards_ + (shard < lowercaseSymbols.size() % shards_ ? 1 : 0);
+        std::vector<std::string> shardStreams;
+        std::vector<InstrumentId> shardInstruments;
+        for (size_t i = offset; i < offset + count; ++i) {
+            for (std::string_view streamName : streamNames) {
+                shardStreams.push_back(lowercaseSymbols[i] + "@" + std::string(streamName));
+            }
+            if (instruments[i] != INVALID_INSTRUMENT_ID) {
+                shardInstruments.push_back(instruments[i]);
+            }
+        }
+        offset += count;
+        streamCount += shardStreams.size();
+        for (size_t leg = 0; leg < legs_; ++leg) {
+            size_t slot = leg * shards_ + shard;
+            // The supervisor may already be replacing the connection of the slot
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            slot_streams_[slot] = shardStreams;
+            slot_instruments_[slot] = shardInstruments;
+            if (!shardStreams.empty()) {
+                connections_[slot]->subscribe(shardStreams);
+            }
+        }
+    }
+    return static_cast<int>(streamCount);
 }
 
-template <>
-AggTradeMDFrame BNBFeeder<AggTradeMDFrame>::parseData(const nlohmann::json& json_data) {
-    AggTradeMDFrame dataFrame;
-    dataFrame.symbol = json_data["s"];
-    dataFrame.price = json_data["p"];
-    dataFrame.quantity = json_data["q"];
-    dataFrame.tradeId = json_data["a"];
-    return dataFrame;
+
+// Stream names joined with '+' for multi stream feeders
+template <typename StreamType>
+std::string BNBFeeder<StreamType>::getStreamName() {
+    std::string name;
+    for (std::string_view streamName : Streams::names()) {
+        name += (name.empty() ? "" : "+") + std::string(streamName);
+    }
+    return name;
 }
 
 // Explicit template instantiations to avoid linker errors
 template class BNBFeeder<BookTickerMDFrame>;
 template class BNBFeeder<KlineMDFrame>;
 template class BNBFeeder<AggTradeMDFrame>;
+template class BNBFeeder<DepthMDFrame>;
+template class BNBFeeder<QuoteTradeUpdate>;
+template class BNBFeeder<MarketDataUpdate>;
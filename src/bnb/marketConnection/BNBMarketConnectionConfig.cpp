@@ -4,6 +4,7 @@
 #include <boost/property_tree/ini_parser.hpp>
 #include <boost/lexical_cast.hpp>
 #include <stdexcept>
+#include <sstream>
 
 BNBMarketConnectionConfig loadConfig(const std::string& configFile) {
     BNBMarketConnectionConfig config;
@@ -13,6 +14,7 @@ BNBMarketConnectionConfig loadConfig(const std::string& configFile) {
         boost::property_tree::ini_parser::read_ini(configFile, pt);
 
         config.streamsWsEndpoint = pt.get<std::string>("BNB_MARKET_CONNECTION.streams_ws_endpoint");
+        config.streamsWsEndpointB = pt.get("BNB_MARKET_CONNECTION.streams_ws_endpoint_b", config.streamsWsEndpoint);
         config.apiWsEndpoint = pt.get<std::string>("BNB_MARKET_CONNECTION.api_ws_endpoint");
         config.apiKey = pt.get<std::string>("BNB_MARKET_CONNECTION.api_key");
 
@@ -27,7 +29,32 @@ BNBMarketConnectionConfig loadConfig(const std::string& configFile) {
         }
         config.maxStreamsSubs = boost::lexical_cast<size_t>(pt.get("BNB_MARKET_CONNECTION.maximum_streams_subscriptions", 200));
         config.wsPersistConnection = boost::lexical_cast<bool>(pt.get("BNB_MARKET_CONNECTION.ws_persist_connection", false));
+        config.wsReconnectBackoffMs = boost::lexical_cast<size_t>(pt.get("BNB_MARKET_CONNECTION.ws_reconnect_backoff_ms", 100));
+        config.wsReconnectMaxBackoffMs = boost::lexical_cast<size_t>(pt.get("BNB_MARKET_CONNECTION.ws_reconnect_max_backoff_ms", 30000));
+        config.wsReconnectTimeoutMs = boost::lexical_cast<size_t>(pt.get("BNB_MARKET_CONNECTION.ws_reconnect_timeout_ms", 10000));
+        config.wsMaxConnectionAgeS = boost::lexical_cast<size_t>(pt.get("BNB_MARKET_CONNECTION.ws_max_connection_age_s", 82800));
         config.loginOnConnection = boost::lexical_cast<bool>(pt.get("BNB_MARKET_CONNECTION.login_on_connection", false));
+        config.apiRequestTimeoutMs = boost::lexical_cast<size_t>(pt.get("BNB_MARKET_CONNECTION.api_request_timeout_ms", 10000));
+        config.rateLimitOrderReserveWeight = boost::lexical_cast<uint32_t>(pt.get("BNB_MARKET_CONNECTION.rate_limit_order_reserve_weight", 100));
+        config.rateLimitBulkReserveWeight = boost::lexical_cast<uint32_t>(pt.get("BNB_MARKET_CONNECTION.rate_limit_bulk_reserve_weight", 1000));
+        config.clockSyncIntervalMs = boost::lexical_cast<size_t>(pt.get("BNB_MARKET_CONNECTION.clock_sync_interval_ms", 2000));
+        config.feederQueueCapacity = boost::lexical_cast<size_t>(pt.get("BNB_MARKET_CONNECTION.feeder_queue_capacity", 65536));
+        config.feederWaitStrategy = waitStrategyFromString(pt.get<std::string>("BNB_MARKET_CONNECTION.feeder_wait_strategy", "BLOCKING"));
+        config.feederShards = boost::lexical_cast<size_t>(pt.get("BNB_MARKET_CONNECTION.feeder_shards", 1));
+        config.feederRedundantLegs = boost::lexical_cast<bool>(pt.get("BNB_MARKET_CONNECTION.feeder_redundant_legs", false));
+        config.feederDeliveryMode = deliveryModeFromString(pt.get<std::string>("BNB_MARKET_CONNECTION.feeder_delivery_mode", "QUEUE"));
+        config.wsOptions.busyPoll = boost::lexical_cast<bool>(pt.get("BNB_MARKET_CONNECTION.ws_busy_poll", false));
+        config.wsOptions.tcpNoDelay = boost::lexical_cast<bool>(pt.get("BNB_MARKET_CONNECTION.ws_tcp_nodelay", true));
+        config.wsOptions.soBusyPollUs = boost::lexical_cast<int>(pt.get("BNB_MARKET_CONNECTION.ws_so_busy_poll_us", 0));
+        config.wsOptions.rcvBufBytes = boost::lexical_cast<int>(pt.get("BNB_MARKET_CONNECTION.ws_rcvbuf_bytes", 0));
+        std::stringstream cpus(pt.get<std::string>("BNB_MARKET_CONNECTION.feeder_busy_poll_cpus", ""));
+        for (std::string cpu; std::getline(cpus, cpu, ',');) {
+            config.feederBusyPollCpus.push_back(boost::lexical_cast<int>(cpu));
+        }
+        config.brokerBusyPollCpu = boost::lexical_cast<int>(pt.get("BNB_MARKET_CONNECTION.broker_busy_poll_cpu", -1));
+        config.brokerOrderSessions = boost::lexical_cast<size_t>(pt.get("BNB_MARKET_CONNECTION.broker_order_sessions", 1));
+        config.brokerQuerySessions = boost::lexical_cast<size_t>(pt.get("BNB_MARKET_CONNECTION.broker_query_sessions", 1));
+        config.brokerDispatch = brokerDispatchFromString(pt.get<std::string>("BNB_MARKET_CONNECTION.broker_dispatch", "LEAST_LOADED"));
 
     } catch (const boost::property_tree::ini_parser_error& e) {
         throw std::runtime_error("Failed to load config file: " + std::string(e.what()));
@@ -0,0 +1,141 @@
+#include "bnb/marketConnection/BNBRateLimiter.h"
+#include <algorithm>
+#include <fmt/core.h>
+
+bool RateLimitBucket::tryAcquire(uint32_t amount, uint32_t reserve, uint64_t nowMs) {
+    if (amount == 0) {
+        return true;
+    }
+    uint32_t window = currentWindow(nowMs);
+    uint64_t state = state_.load(std::memory_order_acquire);
+    while (true) {
+        uint64_t used = (windowOf(state) == window) ? usedOf(state) : 0;
+        if (used + amount + reserve > limit_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (state_.compare_exchange_weak(state, pack(window, used + amount), std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return true;
+        }
+    }
+}
+
+void RateLimitBucket::release(uint32_t amount, uint64_t nowMs) {
+    uint32_t window = currentWindow(nowMs);
+    uint64_t state = state_.load(std::memory_order_acquire);
+    while (windowOf(state) == window) {
+        uint32_t used = usedOf(state);
+        if (state_.compare_exchange_weak(state, pack(window, used - std::min(used, amount)), std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return;
+        }
+    }
+}
+
+void RateLimitBucket::correct(uint32_t count, uint32_t limit, uint64_t nowMs) {
+    if (limit > 0) {
+        limit_.store(limit, std::memory_order_relaxed);
+    }
+    uint32_t window = currentWindow(nowMs);
+    uint64_t state = state_.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t used = (windowOf(state) == window) ? std::max(usedOf(state), count) : count;
+        if (state_.compare_exchange_weak(state, pack(window, used), std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return;
+        }
+    }
+}
+
+uint32_t RateLimitBucket::used(uint64_t nowMs) const {
+    uint64_t state = state_.load(std::memory_order_acquire);
+    return (windowOf(state) == currentWindow(nowMs)) ? usedOf(state) : 0;
+}
+
+BNBRateLimiter::BNBRateLimiter(uint32_t orderReserveWeight, uint32_t bulkReserveWeight)
+    : orderReserveWeight_(orderReserveWeight), bulkReserveWeight_(bulkReserveWeight)
+{}
+
+uint32_t BNBRateLimiter::weightReserve(RequestPriority priority) const {
+    switch (priority) {
+        case RequestPriority::ORDER:
+            return 0;
+        case RequestPriority::QUERY:
+            return orderReserveWeight_;
+        case RequestPriority::BULK:
+            return orderReserveWeight_ + bulkReserveWeight_;
+    }
+    return 0;
+}
+
+bool BNBRateLimiter::tryAcquire(const RequestCost& cost, uint64_t nowMs) {
+    if (nowMs < blockedUntilMs_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    if (!requestWeight_.tryAcquire(cost.weight, weightReserve(cost.priority), nowMs)) {
+        return false;
+    }
+    if (!orders10s_.tryAcquire(cost.orders, 0, nowMs)) {
+        requestWeight_.release(cost.weight, nowMs);
+        return false;
+    }
+    if (!ordersDay_.tryAcquire(cost.orders, 0, nowMs)) {
+        orders10s_.release(cost.orders, nowMs);
+        requestWeight_.release(cost.weight, nowMs);
+        return false;
+    }
+    return true;
+}
+
+RateLimitBucket* BNBRateLimiter::find(const std::string& type, const std::string& interval, uint64_t intervalNum) {
+    static constexpr std::pair<const char*, uint64_t> INTERVALS[] = {
+        {"SECOND", 1000}, {"MINUTE", 60 * 1000}, {"HOUR", 60 * 60 * 1000}, {"DAY", 24 * 60 * 60 * 1000}
+    };
+    uint64_t intervalMs = 0;
+    for (const auto& [name, ms] : INTERVALS) {
+        if (interval == name) {
+            intervalMs = ms * intervalNum;
+        }
+    }
+    if (type == "REQUEST_WEIGHT" && intervalMs == requestWeight_.intervalMs()) {
+        return &requestWeight_;
+    }
+    if (type == "ORDERS") {
+        if (intervalMs == orders10s_.intervalMs()) {
+            return &orders10s_;
+        }
+        if (intervalMs == ordersDay_.intervalMs()) {
+            return &ordersDay_;
+        }
+    }
+    return nullptr;
+}
+
+void BNBRateLimiter::release(const RequestCost& cost, uint64_t nowMs) {
+    requestWeight_.release(cost.weight, nowMs);
+    orders10s_.release(cost.orders, nowMs);
+    ordersDay_.release(cost.orders, nowMs);
+}
+
+void BNBRateLimiter::update(const nlohmann::json& rateLimits, uint64_t nowMs) {
+    for (const auto& rateLimit : rateLimits) {
+        RateLimitBucket* bucket = find(rateLimit.value("rateLimitType", ""), rateLimit.value("interval", ""), rateLimit.value("intervalNum", uint64_t(1)));
+        if (bucket != nullptr) {
+            bucket->correct(rateLimit.value("count", uint32_t(0)), rateLimit.value("limit", uint32_t(0)), nowMs);
+        }
+    }
+}
+
+void BNBRateLimiter::blockUntil(uint64_t untilMs) {
+    uint64_t blocked = blockedUntilMs_.load(std::memory_order_relaxed);
+    while (untilMs > blocked && !blockedUntilMs_.compare_exchange_weak(blocked, untilMs, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t BNBRateLimiter::nextRefillMs(uint64_t nowMs) const {
+    uint64_t blocked = blockedUntilMs_.load(std::memory_order_relaxed);
+    return (blocked > nowMs) ? blocked : requestWeight_.nextWindowMs(nowMs);
+}
+
+std::string BNBRateLimiter::describe(uint64_t nowMs) const {
+    return fmt::format("weight {}/{} per minute, orders {}/{} per 10s, {}/{} per day",
+                       requestWeight_.used(nowMs), requestWeight_.limit(), orders10s_.used(nowMs), orders10s_.limit(),
+                       ordersDay_.used(nowMs), ordersDay_.limit());
+}
@@ -0,0 +1,205 @@
+#include "bnb/marketConnection/BNBStreamConnection.h"
+#include "bnb/marketConnection/BNBFeeder.h"
+#include "common/logger.hpp"
+#include "common/Clock.h"
+
+template <typename StreamType>
+BNBStreamConnection<StreamType>::BNBStreamConnection(BNBFeeder<StreamType>& feeder, size_t slot, size_t queue, uint64_t generation, const std::string& name, const std::string& uri, size_t maxStreamsSubs) :
+    feeder_(feeder),
+    slot_(slot),
+    queue_(queue),
+    generation_(generation),
+    name_(name),
+    uri_(uri),
+    maxStreamsSubs_(maxStreamsSubs) {
+}
+
+template <typename StreamType>
+BNBStreamConnection<StreamType>::~BNBStreamConnection() {
+    stop();
+}
+
+template <typename StreamType>
+void BNBStreamConnection<StreamType>::start() {
+    running_ = true;
+    WebSocketListener::resetClient();
+    ws_thread_ = std::thread([this]() {
+        connect(uri_);
+        WebSocketListener::startClient();
+    });
+}
+
+// Never called from the io thread, it joins it
+template <typename StreamType>
+void BNBStreamConnection<StreamType>::stop() {
+    if (running_) {
+        running_ = false;
+        WebSocketListener::stopClient();
+        if (ws_thread_.joinable()) {
+            ws_thread_.join();
+        }
+    }
+}
+
+template <typename StreamType>
+void BNBStreamConnection<StreamType>::subscribe(const std::vector<std::string>& streams) {
+    std::lock_guard<std::mutex> lock(subscription_mutex_);
+    streams_ = streams;
+    LOG_INFO("[FEEDER][CONN {}] Subscribing to {} streams", name_, streams_.size());
+    if (open_) {
+        sendSubscriptions();
+    }
+}
+
+// subscription_mutex_ must be held
+template <typename StreamType>
+void BNBStreamConnection<StreamType>::sendSubscriptions() {
+    subscribed_.store(streams_.empty(), std::memory_order_release);
+    size_t chunk_size = std::max<size_t>(maxStreamsSubs_/4, 1);
+    for (size_t i = 0; i < streams_.size(); i += chunk_size) {
+        std::vector<std::string> chunk(streams_.begin() + i, streams_.begin() + std::min(streams_.size(), i + chunk_size));
+
+        int request_id = next_request_id_++;
+        nlohmann::json request;
+        request["method"] = "SUBSCRIBE";
+        request["params"] = chunk;
+        request["id"] = request_id;
+
+        pending_requests_.insert(request_id);
+        writeWS(request.dump());
+    }
+}
+
+template <typename StreamType>
+void BNBStreamConnection<StreamType>::onOpen(websocketpp::connection_hdl hdl) {
+    WebSocketListener::onOpen(hdl);
+    std::lock_guard<std::mutex> lock(subscription_mutex_);
+    open_ = true;
+    sendSubscriptions();
+}
+
+template <typename StreamType>
+void BNBStreamConnection<StreamType>::onMessage(websocketpp::connection_hdl hdl, wsppclient::message_ptr msg) {
+    try {
+        uint64_t receiveTime = Clock::now();
+        std::string_view payload = msg->get_payload();
+        LOG_DEBUG("[FEEDER][CONN {}] onMessage: {}", name_, payload);
+
+        // Fast path, market data is decoded in place without building a DOM
+        StreamType dataFrame;
+        switch (BNBStreamDecoder::decode(payload, feeder_.getInstrumentRegistry(), dataFrame)) {
+            case DecodeResult::FRAME:
+                // Large depth events are published chunk by chunk
+                while (!isLastChunk(dataFrame)) {
+                    StreamType nextFrame = nextChunk(dataFrame);
+                    stamp(dataFrame, receiveTime);
+                    feeder_.publish(slot_, queue_, std::move(dataFrame));
+                    if (BNBStreamDecoder::decodeNextChunk(payload, nextFrame) != DecodeResult::FRAME) {
+                        LOG_WARNING("[FEEDER][CONN {}] Could not decode depth chunk: {}", name_, payload);
+                        return;
+                    }
+                    dataFrame = nextFrame;
+                }
+                stamp(dataFrame, receiveTime);
+                updatesCount_.fetch_add(1, std::memory_order_relaxed);
+                feeder_.publish(slot_, queue_, std::move(dataFrame));
+                return;
+            case DecodeResult::UNKNOWN_INSTRUMENT:
+                LOG_DEBUG("[FEEDER][CONN {}] Dropping frame for unregistered instrument: {}", name_, payload);
+                return;
+            case DecodeResult::MALFORMED:
+                LOG_WARNING("[FEEDER][CONN {}] Could not decode market data frame: {}", name_, payload);
+                return;
+            case DecodeResult::CONTROL:
+                onControlMessage(payload);
+                return;
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("[FEEDER][CONN {}] onMessage error: {}", name_, e.what());
+    }
+}
+
+template <typename StreamType>
+void BNBStreamConnection<StreamType>::stamp(StreamType& dataFrame, uint64_t receiveTime) {
+    MarketDataFrame& header = StreamSet<StreamType>::header(dataFrame);
+    header.receiveTime = receiveTime;
+    header.parseTime = Clock::now();
+}
+
+template <typename StreamType>
+void BNBStreamConnection<StreamType>::onControlMessage(std::string_view payload) {
+    auto json_data = nlohmann::json::parse(payload);
+
+    // Check if the message contains an error object
+    if (json_data.contains("error")) {
+        auto error_data = json_data["error"];
+        int error_code = error_data.value("code", 0);
+        std::string error_msg = error_data.value("msg", "Unknown error");
+
+        LOG_ERROR("[FEEDER][CONN {}] Error received - Code: {}, Message: {}", name_, error_code, error_msg);
+
+        // If the message has an ID, log that too
+        if (json_data.contains("id")) {
+            int message_id = json_data["id"];
+            LOG_ERROR("[FEEDER][CONN {}] Error associated with message ID: {}", name_, message_id);
+        }
+        return;
+    }
+
+    // Check if the message is a response to a request
+    if (json_data.contains("id")) {
+        int message_id = json_data["id"];
+        std::lock_guard<std::mutex> lock(subscription_mutex_);
+        if (pending_requests_.count(message_id)) {
+            pending_requests_.erase(message_id);
+            LOG_INFO("[FEEDER][CONN {}] Subscription confirmed for message ID: {}", name_, message_id);
+            if (pending_requests_.empty()) {
+                subscribed_.store(true, std::memory_order_release);
+            }
+
+            // Additional processing for the response if needed
+            if (json_data.contains("result") && json_data["result"].is_null()) {
+                LOG_INFO("[FEEDER][CONN {}] Subscription to stream was successful.", name_);
+            } else {
+                LOG_WARNING("[FEEDER][CONN {}] Unexpected result in subscription response: {}", name_, payload);
+            }
+            return;
+        }
+    }
+
+    LOG_WARNING("[FEEDER][CONN {}] Unhandled message: {}", name_, payload);
+}
+
+template <typename StreamType>
+void BNBStreamConnection<StreamType>::onClose(websocketpp::connection_hdl hdl) {
+    WebSocketListener::onClose(hdl);
+    onDown();
+}
+
+template <typename StreamType>
+void BNBStreamConnection<StreamType>::onFail(websocketpp::connection_hdl hdl) {
+    WebSocketListener::onFail(hdl);
+    onDown();
+}
+
+template <typename StreamType>
+void BNBStreamConnection<StreamType>::onDown() {
+    {
+        std::lock_guard<std::mutex> lock(subscription_mutex_);
+        open_ = false;
+        pending_requests_.clear();
+    }
+    subscribed_.store(false, std::memory_order_release);
+    down_.store(true, std::memory_order_release);
+    if (running_) {
+        feeder_.onConnectionLost(slot_, generation_);
+    }
+}
+
+// Explicit template instantiations to avoid linker errors
+template class BNBStreamConnection<BookTickerMDFrame>;
+template class BNBStreamConnection<KlineMDFrame>;
+template class BNBStreamConnection<AggTradeMDFrame>;
+template class BNBStreamConnection<DepthMDFrame>;
+template class BNBStreamConnection<QuoteTradeUpdate>;
+template class BNBStreamConnection<MarketDataUpdate>;
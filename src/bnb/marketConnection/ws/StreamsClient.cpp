@@ -61,10 +61,10 @@ namespace WS
             pendingRequests_.insert(request_id);
         }
         
-        void StreamsClient::onMessage(websocketpp::connection_hdl hdl, websocketpp::client<websocketpp::config::asio_client>::message_ptr msg)
+        void StreamsClient::onMessage(websocketpp::connection_hdl hdl, wsppclient::message_ptr msg)
         {
             try {
-                std::string payload = msg->get_payload();
+                const std::string& payload = msg->get_payload();
                 LOG_DEBUG("[STREAMS_CLIENT] onMessage: {}", payload);
 
                 auto jsonData = nlohmann::json::parse(payload);
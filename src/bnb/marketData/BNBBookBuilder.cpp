@@ -0,0 +1,154 @@
+#include "bnb/marketData/BNBBookBuilder.h"
+#include "bnb/utils/BNBRequests/MarketData.h"
+#include "common/logger.hpp"
+
+BNBBookBuilder::BNBBookBuilder(const BNBMarketConnectionConfig& config, BNBBroker& broker, size_t ladderTicks) :
+    broker_(broker),
+    feeder_(config),
+    ladderTicks_(ladderTicks) {
+    batch_.reserve(MAX_BATCH_SIZE);
+}
+
+BNBBookBuilder::~BNBBookBuilder() {
+    stop();
+}
+
+void BNBBookBuilder::subscribe(const InstrumentRegistry& registry, const std::vector<Symbol>& symbols) {
+    registry_ = &registry;
+    books_.resize(registry.size());
+    std::vector<std::string> names;
+    for (Symbol symbol : symbols) {
+        InstrumentId instrument = symbol.getId();
+        if (instrument >= books_.size()) {
+            throw std::runtime_error("[BOOK_BUILDER] Symbol " + symbol.to_str() + " is not in the instrument registry.");
+        }
+        Price tickSize = symbol.getFilter().getTickSize();
+        if (tickSize.isZero()) {
+            LOG_WARNING("[BOOK_BUILDER] No tick size for {}, its book is not kept", symbol.to_str());
+            continue;
+        }
+        books_[instrument].book = std::make_unique<BNBOrderBook>(instrument, tickSize, ladderTicks_);
+        waitSnapshot(instrument, std::chrono::milliseconds(0));
+        names.push_back(symbol.to_str());
+    }
+
+    feeder_.setInstrumentRegistry(registry);
+    // A depth snapshot is not a frame, the lost books are dropped and resynced by poll
+    feeder_.setSnapshotProvider([this](const std::vector<InstrumentId>& instruments, BNBFeeder<DepthMDFrame>::SnapshotCallback done) {
+        {
+            std::lock_guard<std::mutex> lock(handover_mutex_);
+            lost_.insert(lost_.end(), instruments.begin(), instruments.end());
+        }
+        done({});
+    });
+    feeder_.subscribeToTickers(names);
+    LOG_INFO("[BOOK_BUILDER] Keeping {} order books of {} ticks", names.size(), ladderTicks_);
+}
+
+void BNBBookBuilder::start() {
+    feeder_.start();
+}
+
+void BNBBookBuilder::stop() {
+    feeder_.stop();
+}
+
+size_t BNBBookBuilder::poll() {
+    std::vector<Snapshot> completed;
+    std::vector<InstrumentId> lost;
+    {
+        std::lock_guard<std::mutex> lock(handover_mutex_);
+        completed.swap(completed_);
+        lost.swap(lost_);
+    }
+    for (InstrumentId instrument : lost) {
+        BookState& state = books_[instrument];
+        if (state.book) {
+            LOG_WARNING("[BOOK_BUILDER] Depth stream of {} lost, waiting for a new snapshot", registry_->getSymbol(instrument));
+            state.book->invalidate();
+            waitSnapshot(instrument, std::chrono::milliseconds(0));
+        }
+    }
+    for (const auto& snapshot : completed) {
+        applySnapshot(snapshot);
+    }
+
+    size_t count = feeder_.poll(batch_, MAX_BATCH_SIZE);
+    for (const auto& frame : batch_) {
+        BookState& state = books_[frame.instrumentId];
+        if (state.book && !state.book->onDepth(frame)) {
+            waitSnapshot(frame.instrumentId, std::chrono::milliseconds(0));
+        }
+    }
+
+    // Snapshots are requested once diffs are buffered, so that the first diffs connect to them
+    if (!waiting_.empty()) {
+        auto now = std::chrono::steady_clock::now();
+        size_t kept = 0;
+        for (InstrumentId instrument : waiting_) {
+            BookState& state = books_[instrument];
+            if (!state.requested && state.book->getPendingCount() > 0 && now >= state.retryAt) {
+                state.waiting = false;
+                requestSnapshot(instrument);
+            } else {
+                waiting_[kept++] = instrument;
+            }
+        }
+        waiting_.resize(kept);
+    }
+    return count;
+}
+
+const BNBOrderBook* BNBBookBuilder::getBook(InstrumentId instrument) const {
+    if (instrument >= books_.size() || !books_[instrument].book || !books_[instrument].book->isSynced()) {
+        return nullptr;
+    }
+    return books_[instrument].book.get();
+}
+
+void BNBBookBuilder::requestSnapshot(InstrumentId instrument) {
+    BookState& state = books_[instrument];
+    state.requested = true;
+    request req = BNBRequests::MarketData::orderBook(registry_->getSymbol(instrument));
+    try {
+        broker_.sendRequest(req, [this, instrument](nlohmann::json response) {
+            std::lock_guard<std::mutex> lock(handover_mutex_);
+            completed_.push_back(Snapshot{instrument, std::move(response)});
+        }, RequestCosts::ORDER_BOOK);
+    } catch (const std::exception& e) {
+        LOG_WARNING("[BOOK_BUILDER] Could not request the depth snapshot of {}: {}", registry_->getSymbol(instrument), e.what());
+        state.requested = false;
+        waitSnapshot(instrument, SNAPSHOT_RETRY_DELAY);
+    }
+}
+
+void BNBBookBuilder::applySnapshot(const Snapshot& snapshot) {
+    BookState& state = books_[snapshot.instrument];
+    state.requested = false;
+    auto result = snapshot.response.find("result");
+    if (result == snapshot.response.end() || !result->is_object()) {
+        LOG_WARNING("[BOOK_BUILDER] Depth snapshot of {} failed: {}", registry_->getSymbol(snapshot.instrument), snapshot.response.dump());
+        waitSnapshot(snapshot.instrument, SNAPSHOT_RETRY_DELAY);
+        return;
+    }
+    ++snapshots_;
+    try {
+        if (!state.book->applySnapshot(*result)) {
+            // Older than the buffered diffs, a newer one is needed right away
+            waitSnapshot(snapshot.instrument, std::chrono::milliseconds(0));
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("[BOOK_BUILDER] Invalid depth snapshot of {}: {}", registry_->getSymbol(snapshot.instrument), e.what());
+        state.book->invalidate();
+        waitSnapshot(snapshot.instrument, SNAPSHOT_RETRY_DELAY);
+    }
+}
+
+void BNBBookBuilder::waitSnapshot(InstrumentId instrument, std::chrono::milliseconds delay) {
+    BookState& state = books_[instrument];
+    state.retryAt = std::chrono::steady_clock::now() + delay;
+    if (!state.waiting) {
+        state.waiting = true;
+        waiting_.push_back(instrument);
+    }
+}
@@ -0,0 +1,101 @@
+#include "bnb/marketData/BNBOrderBook.h"
+#include "common/logger.hpp"
+
+BNBOrderBook::BNBOrderBook(InstrumentId instrument, Price tickSize, size_t ladderTicks) :
+    instrument_(instrument),
+    bids_(BookSide::BID, tickSize, ladderTicks),
+    asks_(BookSide::ASK, tickSize, ladderTicks) {
+}
+
+bool BNBOrderBook::onDepth(const DepthMDFrame& frame) {
+    if (!synced_) {
+        if (pending_.size() >= MAX_PENDING_FRAMES) {
+            pending_.clear();
+        }
+        pending_.push_back(frame);
+        return true;
+    }
+    return apply(frame);
+}
+
+bool BNBOrderBook::applySnapshot(const nlohmann::json& snapshot) {
+    bids_.clear();
+    asks_.clear();
+    for (const auto& level : snapshot["bids"]) {
+        bids_.update(Price::fromString(level[0].get<std::string>()), Qty::fromString(level[1].get<std::string>()));
+    }
+    for (const auto& level : snapshot["asks"]) {
+        asks_.update(Price::fromString(level[0].get<std::string>()), Qty::fromString(level[1].get<std::string>()));
+    }
+    last_update_id_ = snapshot["lastUpdateId"].get<uint64_t>();
+    next_chunk_ = 0;
+    synced_ = true;
+
+    std::vector<DepthMDFrame> pending;
+    pending.swap(pending_);
+    for (const auto& frame : pending) {
+        if (!synced_) {
+            // A gap was found, keep the newer diffs for the next snapshot
+            pending_.push_back(frame);
+        } else {
+            apply(frame);
+        }
+    }
+    if (synced_) {
+        LOG_INFO("[ORDER_BOOK] Instrument {} synced at update id {} ({} bids, {} asks)", instrument_, last_update_id_, bids_.levelCount(), asks_.levelCount());
+    }
+    return synced_;
+}
+
+void BNBOrderBook::invalidate() {
+    synced_ = false;
+    bids_.clear();
+    asks_.clear();
+    pending_.clear();
+}
+
+bool BNBOrderBook::apply(const DepthMDFrame& frame) {
+    if (frame.finalUpdateId < last_update_id_) {
+        return true;
+    }
+    if (frame.finalUpdateId == last_update_id_) {
+        // Remaining chunks of the last applied event, anything else is already in the book
+        if (next_chunk_ == 0 || frame.chunk < next_chunk_) {
+            return true;
+        }
+        if (frame.chunk > next_chunk_) {
+            reset(frame);
+            return false;
+        }
+        applyLevels(frame);
+        return true;
+    }
+    if (frame.chunk != 0 || frame.firstUpdateId > last_update_id_ + 1) {
+        reset(frame);
+        return false;
+    }
+    last_update_id_ = frame.finalUpdateId;
+    applyLevels(frame);
+    return true;
+}
+
+void BNBOrderBook::applyLevels(const DepthMDFrame& frame) {
+    for (size_t i = 0; i < frame.bidCount; ++i) {
+        bids_.update(frame.bid(i).price, frame.bid(i).qty);
+    }
+    for (size_t i = 0; i < frame.askCount; ++i) {
+        asks_.update(frame.ask(i).price, frame.ask(i).qty);
+    }
+    next_chunk_ = frame.lastChunk ? 0 : frame.chunk + 1;
+}
+
+void BNBOrderBook::reset(const DepthMDFrame& frame) {
+    LOG_WARNING("[ORDER_BOOK] Instrument {} gap after update id {}, got [{}, {}] chunk {}, waiting for a new snapshot",
+        instrument_, last_update_id_, frame.firstUpdateId, frame.finalUpdateId, frame.chunk);
+    ++gaps_;
+    synced_ = false;
+    bids_.clear();
+    asks_.clear();
+    pending_.clear();
+    pending_.push_back(frame);
+}
@@ -0,0 +1,435 @@
+#include "bnb/marketData/BNBStreamDecoder.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace {
+    inline bool isControlKey(std::string_view key) {
+        return key == "id" || key == "result" || key == "error";
+    }
+
+    inline bool parseVolume(std::string_view text, double& value) {
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc() && ptr == text.data() + text.size();
+    }
+
+    inline DecodeResult frameResult(bool complete, const MarketDataFrame& frame) {
+        if (!complete) return DecodeResult::CONTROL;
+        return (frame.instrumentId == INVALID_INSTRUMENT_ID) ? DecodeResult::UNKNOWN_INSTRUMENT : DecodeResult::FRAME;
+    }
+
+    template <size_t I, typename Variant>
+    DecodeResult decodeAlternative(std::string_view data, const InstrumentRegistry& registry, Variant& frame) {
+        if (frame.index() != I) {
+            frame.template emplace<I>();
+        }
+        return BNBStreamDecoder::decode(data, registry, std::get<I>(frame));
+    }
+
+    // The stream names are compared in alternative order, the matching decoder is fixed at compile time
+    template <typename Variant, size_t... I>
+    DecodeResult dispatch(std::string_view name, std::string_view data, const InstrumentRegistry& registry, Variant& frame, std::index_sequence<I...>) {
+        DecodeResult result = DecodeResult::CONTROL;
+        ((name == StreamTraits<std::variant_alternative_t<I, Variant>>::NAME && (result = decodeAlternative<I>(data, registry, frame), true)) || ...);
+        return result;
+    }
+
+    template <typename Variant>
+    DecodeResult decodeCombined(std::string_view payload, const InstrumentRegistry& registry, Variant& frame) {
+        JsonCursor cursor(payload);
+        if (!cursor.enterObject()) return DecodeResult::CONTROL;
+
+        std::string_view key, stream, data;
+        while (cursor.nextKey(key)) {
+            if (key == "stream") {
+                if (!cursor.readString(stream)) return DecodeResult::MALFORMED;
+            } else if (key == "data") {
+                if (!cursor.readRaw(data)) return DecodeResult::MALFORMED;
+            } else if (isControlKey(key)) {
+                return DecodeResult::CONTROL;
+            } else if (!cursor.skipValue()) {
+                return DecodeResult::MALFORMED;
+            }
+        }
+        size_t at = stream.find('@');
+        if (at == std::string_view::npos || data.empty()) return DecodeResult::CONTROL;
+        DecodeResult result = dispatch(stream.substr(at + 1), data, registry, frame, std::make_index_sequence<std::variant_size_v<Variant>>{});
+        std::visit([&](auto& alternative) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(alternative)>, DepthMDFrame>) {
+                alternative.nextChunkOffset += static_cast<uint32_t>(data.data() - payload.data());
+            }
+        }, frame);
+        return result;
+    }
+
+    inline bool readLevel(JsonCursor& cursor, DepthMDFrame& frame, bool bid) {
+        std::string_view value;
+        DepthLevel& slot = bid ? frame.levels[frame.bidCount++] : frame.levels[DepthMDFrame::MAX_LEVELS - 1 - frame.askCount++];
+        return cursor.enterArray()
+            && cursor.readString(value) && Price::parse(value, slot.price)
+            && cursor.nextElement()
+            && cursor.readString(value) && Qty::parse(value, slot.qty)
+            && cursor.leaveArray();
+    }
+}
+
+void JsonCursor::skipWhitespace() {
+    while (cur_ < end_ && (*cur_ == ' ' || *cur_ == '\n' || *cur_ == '\r' || *cur_ == '\t')) {
+        ++cur_;
+    }
+}
+
+bool JsonCursor::expect(char c) {
+    skipWhitespace();
+    if (cur_ < end_ && *cur_ == c) {
+        ++cur_;
+        return true;
+    }
+    return false;
+}
+
+bool JsonCursor::enterObject() {
+    return expect('{');
+}
+
+bool JsonCursor::leaveObject() {
+    return expect('}');
+}
+
+bool JsonCursor::nextKey(std::string_view& key) {
+    skipWhitespace();
+    if (cur_ >= end_ || *cur_ == '}') {
+        return false;
+    }
+    if (*cur_ == ',') {
+        ++cur_;
+    }
+    return readString(key) && expect(':');
+}
+
+bool JsonCursor::enterArray() {
+    return expect('[');
+}
+
+bool JsonCursor::leaveArray() {
+    return expect(']');
+}
+
+bool JsonCursor::nextElement() {
+    skipWhitespace();
+    if (cur_ >= end_ || *cur_ == ']') {
+        return false;
+    }
+    if (*cur_ == ',') {
+        ++cur_;
+    }
+    return true;
+}
+
+bool JsonCursor::readString(std::string_view& value) {
+    if (!expect('"')) {
+        return false;
+    }
+    // memchr is vectorised by the libc, stream payloads never contain escapes
+    const char* close = static_cast<const char*>(std::memchr(cur_, '"', end_ - cur_));
+    if (close == nullptr || close[-1] == '\\') {
+        return false;
+    }
+    value = std::string_view(cur_, close - cur_);
+    cur_ = close + 1;
+    return true;
+}
+
+bool JsonCursor::readUInt(uint64_t& value) {
+    skipWhitespace();
+    auto [ptr, ec] = std::from_chars(cur_, end_, value);
+    if (ec != std::errc()) {
+        return false;
+    }
+    cur_ = ptr;
+    return true;
+}
+
+bool JsonCursor::readInt(int64_t& value) {
+    skipWhitespace();
+    auto [ptr, ec] = std::from_chars(cur_, end_, value);
+    if (ec != std::errc()) {
+        return false;
+    }
+    cur_ = ptr;
+    return true;
+}
+
+bool JsonCursor::readBool(bool& value) {
+    skipWhitespace();
+    if (end_ - cur_ >= 4 && std::memcmp(cur_, "true", 4) == 0) {
+        value = true;
+        cur_ += 4;
+        return true;
+    }
+    if (end_ - cur_ >= 5 && std::memcmp(cur_, "false", 5) == 0) {
+        value = false;
+        cur_ += 5;
+        return true;
+    }
+    return false;
+}
+
+bool JsonCursor::skipValue() {
+    skipWhitespace();
+    if (cur_ >= end_) {
+        return false;
+    }
+    if (*cur_ == '"') {
+        std::string_view ignored;
+        return readString(ignored);
+    }
+    if (*cur_ == '{' || *cur_ == '[') {
+        int depth = 0;
+        while (cur_ < end_) {
+            char c = *cur_;
+            if (c == '"') {
+                std::string_view ignored;
+                if (!readString(ignored)) return false;
+                continue;
+            }
+            if (c == '{' || c == '[') ++depth;
+            if (c == '}' || c == ']') --depth;
+            ++cur_;
+            if (depth == 0) return true;
+        }
+        return false;
+    }
+    // number, true, false, null
+    while (cur_ < end_ && *cur_ != ',' && *cur_ != '}' && *cur_ != ']') {
+        ++cur_;
+    }
+    return true;
+}
+
+bool JsonCursor::readRaw(std::string_view& value) {
+    skipWhitespace();
+    const char* start = cur_;
+    if (!skipValue()) {
+        return false;
+    }
+    value = std::string_view(start, cur_ - start);
+    return true;
+}
+
+// {"u":400900217,"s":"BNBUSDT","b":"25.35190000","B":"31.21000000","a":"25.36520000","A":"40.66000000"}
+DecodeResult BNBStreamDecoder::decode(std::string_view payload, const InstrumentRegistry& registry, BookTickerMDFrame& frame) {
+    JsonCursor cursor(payload);
+    if (!cursor.enterObject()) return DecodeResult::CONTROL;
+
+    int fields = 0;
+    std::string_view key, value;
+    while (cursor.nextKey(key)) {
+        if (key.size() != 1) {
+            if (isControlKey(key)) return DecodeResult::CONTROL;
+            if (!cursor.skipValue()) return DecodeResult::MALFORMED;
+            continue;
+        }
+        bool ok = true;
+        switch (key[0]) {
+            case 's': ok = cursor.readString(value); frame.instrumentId = registry.find(value); ++fields; break;
+            case 'b': ok = cursor.readString(value) && Price::parse(value, frame.bestBidPrice); ++fields; break;
+            case 'B': ok = cursor.readString(value) && Qty::parse(value, frame.bestBidQty); ++fields; break;
+            case 'a': ok = cursor.readString(value) && Price::parse(value, frame.bestAskPrice); ++fields; break;
+            case 'A': ok = cursor.readString(value) && Qty::parse(value, frame.bestAskQty); ++fields; break;
+            case 'u': ok = cursor.readUInt(frame.updateId); break;
+            default: ok = cursor.skipValue(); break;
+        }
+        if (!ok) return DecodeResult::MALFORMED;
+    }
+    return frameResult(fields == 5, frame);
+}
+
+// {"e":"kline","E":123456789,"s":"BNBBTC","k":{"t":123400000,"T":123460000,"s":"BNBBTC","i":"1m",
+//  "f":100,"L":200,"o":"0.0010","c":"0.0020","h":"0.0025","l":"0.0015","v":"1000","n":100,"x":false,
+//  "q":"1.0000","V":"500","Q":"0.500","B":"123456"}}
+DecodeResult BNBStreamDecoder::decode(std::string_view payload, const InstrumentRegistry& registry, KlineMDFrame& frame) {
+    JsonCursor cursor(payload);
+    if (!cursor.enterObject()) return DecodeResult::CONTROL;
+
+    int fields = 0;
+    std::string_view key, value;
+    while (cursor.nextKey(key)) {
+        if (key == "s") {
+            if (!cursor.readString(value)) return DecodeResult::MALFORMED;
+            frame.instrumentId = registry.find(value);
+            ++fields;
+        } else if (key == "E") {
+            if (!cursor.readUInt(frame.exchangeTime)) return DecodeResult::MALFORMED;
+        } else if (key == "k") {
+            if (!cursor.enterObject()) return DecodeResult::MALFORMED;
+            while (cursor.nextKey(key)) {
+                bool ok = true;
+                if (key.size() != 1) {
+                    ok = cursor.skipValue();
+                } else {
+                    switch (key[0]) {
+                        case 't': ok = cursor.readUInt(frame.openTime); ++fields; break;
+                        case 'T': ok = cursor.readUInt(frame.closeTime); ++fields; break;
+                        case 'i':
+                            ok = cursor.readString(value) && value.size() <= KlineMDFrame::MAX_INTERVAL_CHARS;
+                            if (ok) value.copy(frame.interval, value.size());
+                            ++fields;
+                            break;
+                        case 'o': ok = cursor.readString(value) && Price::parse(value, frame.open); ++fields; break;
+                        case 'h': ok = cursor.readString(value) && Price::parse(value, frame.high); ++fields; break;
+                        case 'l': ok = cursor.readString(value) && Price::parse(value, frame.low); ++fields; break;
+                        case 'c': ok = cursor.readString(value) && Price::parse(value, frame.close); ++fields; break;
+                        case 'v': ok = cursor.readString(value) && parseVolume(value, frame.volume); ++fields; break;
+                        case 'q': ok = cursor.readString(value) && parseVolume(value, frame.quoteVolume); ++fields; break;
+                        case 'V': ok = cursor.readString(value) && parseVolume(value, frame.takerBuyVolume); ++fields; break;
+                        case 'Q': ok = cursor.readString(value) && parseVolume(value, frame.takerBuyQuoteVolume); ++fields; break;
+                        case 'f': ok = cursor.readInt(frame.firstTradeId); ++fields; break;
+                        case 'L': ok = cursor.readInt(frame.lastTradeId); ++fields; break;
+                        case 'n': ok = cursor.readUInt(frame.tradeCount); ++fields; break;
+                        case 'x': ok = cursor.readBool(frame.isClosed); ++fields; break;
+                        default: ok = cursor.skipValue(); break;
+                    }
+                }
+                if (!ok) return DecodeResult::MALFORMED;
+            }
+            if (!cursor.leaveObject()) return DecodeResult::MALFORMED;
+        } else if (isControlKey(key)) {
+            return DecodeResult::CONTROL;
+        } else if (!cursor.skipValue()) {
+            return DecodeResult::MALFORMED;
+        }
+    }
+    return frameResult(fields == 16, frame);
+}
+
+// {"e":"aggTrade","E":123456789,"s":"BNBBTC","a":12345,"p":"0.001","q":"100","f":100,"l":105,"T":123456785,"m":true,"M":true}
+DecodeResult BNBStreamDecoder::decode(std::string_view payload, const InstrumentRegistry& registry, AggTradeMDFrame& frame) {
+    JsonCursor cursor(payload);
+    if (!cursor.enterObject()) return DecodeResult::CONTROL;
+
+    int fields = 0;
+    std::string_view key, value;
+    while (cursor.nextKey(key)) {
+        if (key.size() != 1) {
+            if (isControlKey(key)) return DecodeResult::CONTROL;
+            if (!cursor.skipValue()) return DecodeResult::MALFORMED;
+            continue;
+        }
+        bool ok = true;
+        switch (key[0]) {
+            case 's': ok = cursor.readString(value); frame.instrumentId = registry.find(value); ++fields; break;
+            case 'p': ok = cursor.readString(value) && Price::parse(value, frame.price); ++fields; break;
+            case 'q': ok = cursor.readString(value) && Qty::parse(value, frame.quantity); ++fields; break;
+            case 'a': ok = cursor.readUInt(frame.tradeId); ++fields; break;
+            case 'f': ok = cursor.readUInt(frame.firstTradeId); ++fields; break;
+            case 'l': ok = cursor.readUInt(frame.lastTradeId); ++fields; break;
+            case 'T': ok = cursor.readUInt(frame.transactionTime); ++fields; break;
+            case 'm': ok = cursor.readBool(frame.isBuyerMaker); ++fields; break;
+            case 'E': ok = cursor.readUInt(frame.exchangeTime); break;
+            default: ok = cursor.skipValue(); break;
+        }
+        if (!ok) return DecodeResult::MALFORMED;
+    }
+    return frameResult(fields == 8, frame);
+}
+
+// {"e":"depthUpdate","E":123456789,"s":"BNBBTC","U":157,"u":160,"b":[["0.0024","10"]],"a":[["0.0026","100"]]}
+DecodeResult BNBStreamDecoder::decode(std::string_view payload, const InstrumentRegistry& registry, DepthMDFrame& frame) {
+    JsonCursor cursor(payload);
+    if (!cursor.enterObject()) return DecodeResult::CONTROL;
+
+    // Levels are numbered in payload order across both sides, the chunk keeps its own range
+    const size_t first = frame.chunk * DepthMDFrame::MAX_LEVELS;
+    const size_t last = first + DepthMDFrame::MAX_LEVELS;
+    size_t level = 0;
+    frame.bidCount = 0;
+    frame.askCount = 0;
+
+    int fields = 0;
+    std::string_view key, value;
+    while (cursor.nextKey(key)) {
+        if (key.size() != 1) {
+            if (isControlKey(key)) return DecodeResult::CONTROL;
+            if (!cursor.skipValue()) return DecodeResult::MALFORMED;
+            continue;
+        }
+        bool ok = true;
+        switch (key[0]) {
+            case 's': ok = cursor.readString(value); frame.instrumentId = registry.find(value); ++fields; break;
+            case 'U': ok = cursor.readUInt(frame.firstUpdateId); ++fields; break;
+            case 'u': ok = cursor.readUInt(frame.finalUpdateId); ++fields; break;
+            case 'E': ok = cursor.readUInt(frame.exchangeTime); break;
+            case 'b':
+            case 'a': {
+                bool bid = (key[0] == 'b');
+                if (!cursor.enterArray()) return DecodeResult::MALFORMED;
+                while (cursor.nextElement()) {
+                    ok = (level < first || level >= last) ? cursor.skipValue() : readLevel(cursor, frame, bid);
+                    if (!ok) return DecodeResult::MALFORMED;
+                    if (++level == last) {
+                        frame.nextChunkBid = bid;
+                        frame.nextChunkOffset = static_cast<uint32_t>(cursor.position() - payload.data());
+                    }
+                }
+                ok = cursor.leaveArray();
+                ++fields;
+                break;
+            }
+            default: ok = cursor.skipValue(); break;
+        }
+        if (!ok) return DecodeResult::MALFORMED;
+    }
+    if (frame.chunk >= DepthMDFrame::MAX_CHUNKS || (frame.chunk > 0 && level <= first)) return DecodeResult::MALFORMED;
+    frame.lastChunk = (level <= last);
+    frame.levelCount = static_cast<uint16_t>(level);
+    return frameResult(fields == 5, frame);
+}
+
+// The cursor starts inside the level array the previous chunk stopped in, the header
+// fields were copied by nextChunk
+DecodeResult BNBStreamDecoder::decodeNextChunk(std::string_view payload, DepthMDFrame& frame) {
+    if (frame.chunk >= DepthMDFrame::MAX_CHUNKS || frame.nextChunkOffset > payload.size()) return DecodeResult::MALFORMED;
+    JsonCursor cursor(payload.substr(frame.nextChunkOffset));
+
+    size_t level = frame.chunk * DepthMDFrame::MAX_LEVELS;
+    const size_t last = level + DepthMDFrame::MAX_LEVELS;
+    if (level >= frame.levelCount) return DecodeResult::MALFORMED;
+    const size_t end = std::min<size_t>(last, frame.levelCount);
+    bool bid = frame.nextChunkBid;
+    std::string_view key;
+    while (level < end) {
+        if (cursor.nextElement()) {
+            if (!readLevel(cursor, frame, bid)) return DecodeResult::MALFORMED;
+            ++level;
+            continue;
+        }
+        // End of this side, move on to the other level array
+        if (!cursor.leaveArray()) return DecodeResult::MALFORMED;
+        bool found = false;
+        while (!found && cursor.nextKey(key)) {
+            found = (key == "b" || key == "a");
+            if (found) {
+                bid = (key == "b");
+                if (!cursor.enterArray()) return DecodeResult::MALFORMED;
+            } else if (!cursor.skipValue()) {
+                return DecodeResult::MALFORMED;
+            }
+        }
+        if (!found) return DecodeResult::MALFORMED;
+    }
+    frame.lastChunk = (frame.levelCount <= last);
+    frame.nextChunkBid = bid;
+    frame.nextChunkOffset += static_cast<uint32_t>(cursor.position() - (payload.data() + frame.nextChunkOffset));
+    return DecodeResult::FRAME;
+}
+
+DecodeResult BNBStreamDecoder::decode(std::string_view payload, const InstrumentRegistry& registry, QuoteTradeUpdate& frame) {
+    return decodeCombined(payload, registry, frame);
+}
+
+DecodeResult BNBStreamDecoder::decode(std::string_view payload, const InstrumentRegistry& registry, MarketDataUpdate& frame) {
+    return decodeCombined(payload, registry, frame);
+}
@@ -12,31 +12,31 @@ namespace BNBRequests
     }
     request Account::unfilledOrderCount(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
     request Account::orderHistory(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
     request Account::allOrderHistory(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
     request Account::tradeHistory(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
     request Account::preventedMatches(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
     request Account::allocations(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
     request Account::commissionRates(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 }
 
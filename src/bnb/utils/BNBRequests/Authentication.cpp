@@ -2,18 +2,17 @@
 
 namespace BNBRequests
 {
+    // Ed25519 keys only, signed with apiKey and timestamp like any other signed request
     request Authentication::logIn(){
-        throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        std::map<std::string, std::string> params;
+        return RequestsBuilder::paramsSignedRequest("session.logon", params);
     }
 
     request Authentication::querySessionStatus(){
-        throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return RequestsBuilder::basicRequest("session.status");
     }
 
     request Authentication::logOut(){
-        throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return RequestsBuilder::basicRequest("session.logout");
     }
 }
@@ -0,0 +1,49 @@
+#include "bnb/utils/BNBRequests/Ed25519Signer.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+
+static_assert(Ed25519Signer::SIGNATURE_CHARS + 1 == sodium_base64_ENCODED_LEN(crypto_sign_BYTES, sodium_base64_VARIANT_ORIGINAL));
+
+Ed25519Signer::Ed25519Signer(const std::string& privateKeyPath) {
+    if (sodium_init() < 0) {
+        throw std::runtime_error("[Ed25519Signer] Failed to initialize libsodium");
+    }
+    FILE* file = fopen(privateKeyPath.c_str(), "r");
+    if (file == nullptr) {
+        throw std::runtime_error("[Ed25519Signer] Could not open private key file: " + privateKeyPath);
+    }
+    EVP_PKEY* key = PEM_read_PrivateKey(file, nullptr, nullptr, nullptr);
+    fclose(file);
+    if (key == nullptr) {
+        throw std::runtime_error("[Ed25519Signer] Failed to read a PEM private key from " + privateKeyPath);
+    }
+
+    // OpenSSL holds the 32 bytes seed, libsodium signs with the seed and public key pair
+    unsigned char seed[crypto_sign_SEEDBYTES];
+    size_t seedSize = sizeof(seed);
+    bool valid = EVP_PKEY_base_id(key) == EVP_PKEY_ED25519
+        && EVP_PKEY_get_raw_private_key(key, seed, &seedSize) == 1
+        && seedSize == crypto_sign_SEEDBYTES;
+    EVP_PKEY_free(key);
+    if (!valid) {
+        throw std::runtime_error("[Ed25519Signer] Not an Ed25519 private key: " + privateKeyPath);
+    }
+    unsigned char publicKey[crypto_sign_PUBLICKEYBYTES];
+    crypto_sign_seed_keypair(publicKey, secretKey_, seed);
+    sodium_memzero(seed, sizeof(seed));
+}
+
+Ed25519Signer::~Ed25519Signer() {
+    sodium_memzero(secretKey_, sizeof(secretKey_));
+}
+
+void Ed25519Signer::sign(std::string_view payload, char* signature) const {
+    unsigned char raw[crypto_sign_BYTES];
+    crypto_sign_detached(raw, nullptr, reinterpret_cast<const unsigned char*>(payload.data()), payload.size(), secretKey_);
+    char base64[SIGNATURE_CHARS + 1];
+    sodium_bin2base64(base64, sizeof(base64), raw, sizeof(raw), sodium_base64_VARIANT_ORIGINAL);
+    std::memcpy(signature, base64, SIGNATURE_CHARS);
+}
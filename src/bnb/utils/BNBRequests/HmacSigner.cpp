@@ -0,0 +1,78 @@
+#include "bnb/utils/BNBRequests/HmacSigner.h"
+#include <array>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t BLOCK_BYTES = 64;
+
+    // Two hex chars per byte value
+    constexpr std::array<char, 512> HEX_PAIRS = []() {
+        constexpr char HEX[] = "0123456789abcdef";
+        std::array<char, 512> pairs{};
+        for (size_t i = 0; i < 256; ++i) {
+            pairs[2 * i] = HEX[i >> 4];
+            pairs[2 * i + 1] = HEX[i & 0xf];
+        }
+        return pairs;
+    }();
+
+    struct MdCtxDeleter {
+        void operator()(EVP_MD_CTX* ctx) const { EVP_MD_CTX_free(ctx); }
+    };
+
+    EVP_MD_CTX* padState(const unsigned char* key, unsigned char pad) {
+        unsigned char block[BLOCK_BYTES];
+        for (size_t i = 0; i < BLOCK_BYTES; ++i) {
+            block[i] = key[i] ^ pad;
+        }
+        EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+        if (ctx == nullptr || EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr) != 1 || EVP_DigestUpdate(ctx, block, BLOCK_BYTES) != 1) {
+            EVP_MD_CTX_free(ctx);
+            throw std::runtime_error("[HmacSigner] Failed to initialize the SHA256 pad state");
+        }
+        return ctx;
+    }
+}
+
+HmacSigner::HmacSigner(std::string_view key) {
+    unsigned char block[BLOCK_BYTES] = {};
+    if (key.size() > BLOCK_BYTES) {
+        unsigned int size = 0;
+        if (EVP_Digest(key.data(), key.size(), block, &size, EVP_sha256(), nullptr) != 1) {
+            throw std::runtime_error("[HmacSigner] Failed to hash the secret key");
+        }
+    } else {
+        std::copy(key.begin(), key.end(), block);
+    }
+    inner_ = padState(block, 0x36);
+    try {
+        outer_ = padState(block, 0x5c);
+    } catch (...) {
+        EVP_MD_CTX_free(inner_);
+        throw;
+    }
+}
+
+HmacSigner::~HmacSigner() {
+    EVP_MD_CTX_free(inner_);
+    EVP_MD_CTX_free(outer_);
+}
+
+void HmacSigner::sign(std::string_view payload, char* signature) const {
+    thread_local std::unique_ptr<EVP_MD_CTX, MdCtxDeleter> work(EVP_MD_CTX_new());
+    unsigned char digest[DIGEST_BYTES];
+    unsigned int size = 0;
+    if (EVP_MD_CTX_copy_ex(work.get(), inner_) != 1
+        || EVP_DigestUpdate(work.get(), payload.data(), payload.size()) != 1
+        || EVP_DigestFinal_ex(work.get(), digest, &size) != 1
+        || EVP_MD_CTX_copy_ex(work.get(), outer_) != 1
+        || EVP_DigestUpdate(work.get(), digest, DIGEST_BYTES) != 1
+        || EVP_DigestFinal_ex(work.get(), digest, &size) != 1) {
+        throw std::runtime_error("[HmacSigner] Signing failed");
+    }
+    for (size_t i = 0; i < DIGEST_BYTES; ++i) {
+        signature[2 * i] = HEX_PAIRS[2 * digest[i]];
+        signature[2 * i + 1] = HEX_PAIRS[2 * digest[i] + 1];
+    }
+}
@@ -3,59 +3,64 @@
 
 namespace BNBRequests
 {
-    request MarketData::orderBook(){
-        throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+    request MarketData::orderBook(const std::string& symbol, int limit){
+        nlohmann::json params = {
+            {"symbol", symbol},
+            {"limit", limit}
+        };
+        std::string method = "depth";
+
+        return RequestsBuilder::paramsUnsignedRequest(method, params);
     }
 
     request MarketData::recentTrades(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 
     request MarketData::historicalTrades(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 
     request MarketData::aggregateTrades(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 
     request MarketData::klines(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 
     request MarketData::uiKlines(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 
     request MarketData::currentAvgPrice(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 
     request MarketData::tickerPriceChangeStats24h(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 
     request MarketData::tickerPriceStatsDay(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 
     request MarketData::tickerPriceChangeStatsCustom(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 
     request MarketData::symbolPriceTicker(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 
     request MarketData::symbolOrderBookTicker(const std::vector<std::string>& symbols){
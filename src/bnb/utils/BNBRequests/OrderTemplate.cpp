@@ -0,0 +1,131 @@
+#include "bnb/utils/BNBRequests/OrderTemplate.h"
+#include <cstring>
+
+namespace {
+    constexpr size_t TIMESTAMP_CHARS = 20;
+}
+
+OrderTemplate::OrderTemplate(const std::string& method, const std::string& symbol, Way side, OrderType type,
+                             const std::map<std::string, std::string>& extraParams)
+    : method_(method), params_(extraParams), hasPrice_(type == OrderType::LIMIT)
+{
+    if (side == Way::HOLD) {
+        throw std::runtime_error("[BNBREQUESTS] Order template for " + symbol + " without a side");
+    }
+    params_["symbol"] = symbol;
+    params_["side"] = (side == Way::BUY) ? "BUY" : "SELL";
+    params_["type"] = (type == OrderType::MARKET) ? "MARKET" : "LIMIT";
+    build();
+}
+
+void OrderTemplate::build()
+{
+    authenticated_ = RequestsBuilder::isSessionAuthenticated();
+
+    // Dynamic params are sorted along with the fixed ones, the signed payload keeps the key order
+    std::map<std::string, Field> dynamicParams{{"quantity", QUANTITY}, {"timestamp", TIMESTAMP}};
+    if (hasPrice_) {
+        dynamicParams["price"] = PRICE;
+    }
+    std::map<std::string, std::string> fixedParams = params_;
+    if (!authenticated_) {
+        fixedParams["apiKey"] = RequestsBuilder::getApiKey();
+    }
+    std::map<std::string, const std::string*> keys;
+    for (const auto& [key, value] : fixedParams) {
+        keys[key] = &value;
+    }
+    for (const auto& [key, field] : dynamicParams) {
+        keys[key] = nullptr;
+    }
+
+    std::string& body = request_.second;
+    body.clear();
+    querySegments_.clear();
+    querySuffix_.clear();
+
+    auto appendSlot = [&body, this](Field field, size_t valueChars) {
+        body += '"';
+        slots_[field] = {body.size(), valueChars + 1};
+        body.append(valueChars + 1, ' ');
+    };
+
+    body += "{\"id\":";
+    appendSlot(ID, RequestsHelper::MAX_REQUEST_ID_CHARS);
+    body += ",\"method\":";
+    RequestsHelper::appendJsonString(body, method_);
+    body += ",\"params\":{";
+
+    bool first = true;
+    for (const auto& [key, value] : keys) {
+        if (!first) {
+            body += ',';
+            querySuffix_ += '&';
+        }
+        first = false;
+        RequestsHelper::appendJsonString(body, key);
+        body += ':';
+        querySuffix_ += key;
+        querySuffix_ += '=';
+        if (value != nullptr) {
+            RequestsHelper::appendJsonString(body, *value);
+            querySuffix_ += *value;
+        } else {
+            Field field = dynamicParams[key];
+            appendSlot(field, field == TIMESTAMP ? TIMESTAMP_CHARS : Qty::MAX_CHARS);
+            querySegments_.push_back({std::move(querySuffix_), field});
+            querySuffix_.clear();
+        }
+    }
+    slots_[SIGNATURE] = Slot();
+    if (!authenticated_) {
+        body += ",\"signature\":";
+        appendSlot(SIGNATURE, RequestsBuilder::MAX_SIGNATURE_CHARS);
+    }
+    body += "}}";
+    query_.reserve(querySuffix_.size() + 256);
+}
+
+void OrderTemplate::writeSlot(Field field, const char* value, size_t size)
+{
+    const Slot& slot = slots_[field];
+    char* out = request_.second.data() + slot.offset;
+    std::memcpy(out, value, size);
+    out[size] = '"';
+    std::memset(out + size + 1, ' ', slot.width - size - 1);
+}
+
+const request& OrderTemplate::fill(Qty quantity, Price price)
+{
+    if (authenticated_ != RequestsBuilder::isSessionAuthenticated()) {
+        build();
+    }
+
+    uint64_t requestId = RequestsHelper::nextRequestId();
+    RequestsHelper::RequestIdText id = RequestsHelper::formatRequestId(requestId);
+    writeSlot(ID, id.data, id.size);
+
+    char values[FIELD_COUNT][Qty::MAX_CHARS];
+    size_t sizes[FIELD_COUNT] = {};
+    sizes[QUANTITY] = quantity.toChars(values[QUANTITY]) - values[QUANTITY];
+    if (hasPrice_) {
+        sizes[PRICE] = price.toChars(values[PRICE]) - values[PRICE];
+    }
+    sizes[TIMESTAMP] = RequestsHelper::writeTimestamp(values[TIMESTAMP]) - values[TIMESTAMP];
+
+    query_.clear();
+    for (const QuerySegment& segment : querySegments_) {
+        query_ += segment.text;
+        query_.append(values[segment.field], sizes[segment.field]);
+        writeSlot(segment.field, values[segment.field], sizes[segment.field]);
+    }
+    query_ += querySuffix_;
+
+    if (!authenticated_) {
+        char signature[RequestsBuilder::MAX_SIGNATURE_CHARS];
+        size_t signatureChars = RequestsBuilder::signPayload(query_, signature);
+        writeSlot(SIGNATURE, signature, signatureChars);
+    }
+    request_.first = requestId;
+    return request_;
+}
@@ -1,10 +1,49 @@
 #include "bnb/utils/BNBRequests/RequestsBuilder.h"
 
+RequestsBuilder::RequestsBuilder(const std::string& apiKey, const std::string& signMethod, const std::string& secret)
+    : apiKey_(apiKey)
+{
+    if (signMethod == "HMAC") {
+        hmacSigner_ = std::make_unique<HmacSigner>(secret);
+    } else if (signMethod == "ED25519") {
+        ed25519Signer_ = std::make_unique<Ed25519Signer>(secret);
+    } else {
+        throw std::runtime_error("[BNBREQUESTS] Unsupported sign method : <" + signMethod + ">");
+    }
+}
+
+void RequestsBuilder::setSessionAuthenticated(bool authenticated)
+{
+    if (instance != nullptr) {
+        instance->sessionAuthenticated_.store(authenticated, std::memory_order_release);
+    }
+}
+
+bool RequestsBuilder::isSessionAuthenticated()
+{
+    return instance != nullptr && instance->sessionAuthenticated_.load(std::memory_order_acquire);
+}
+
+const std::string& RequestsBuilder::getApiKey()
+{
+    return instance->apiKey_;
+}
+
+size_t RequestsBuilder::signPayload(std::string_view payload, char* signature)
+{
+    if (instance->hmacSigner_) {
+        instance->hmacSigner_->sign(payload, signature);
+        return HmacSigner::SIGNATURE_CHARS;
+    }
+    instance->ed25519Signer_->sign(payload, signature);
+    return Ed25519Signer::SIGNATURE_CHARS;
+}
+
 request RequestsBuilder::basicRequest(const std::string& method)
 {
-    std::string requestId = RequestsHelper::generateRequestId();
+    uint64_t requestId = RequestsHelper::nextRequestId();
     nlohmann::json requestBody = {
-        {"id", requestId},
+        {"id", RequestsHelper::formatRequestId(requestId).view()},
         {"method", method}
     };
 
@@ -13,9 +52,9 @@ request RequestsBuilder::basicRequest(const std::string& method)
 
 request RequestsBuilder::paramsUnsignedRequest(const std::string& method, const nlohmann::json& params)
 {
-    std::string requestId = RequestsHelper::generateRequestId();
+    uint64_t requestId = RequestsHelper::nextRequestId();
     nlohmann::json requestBody = {
-        {"id", requestId},
+        {"id", RequestsHelper::formatRequestId(requestId).view()},
         {"method", method},
         {"params", params}
     };
@@ -23,111 +62,78 @@ request RequestsBuilder::paramsUnsignedRequest(const std::string& method, const
     return std::make_pair(requestId, requestBody.dump());
 }
 
+// Signs the query string from a per thread buffer and writes the JSON body directly,
+// https://developers.binance.com/docs/binance-spot-api-docs/web-socket-api/request-security
 request RequestsBuilder::paramsSignedRequest(const std::string& method, std::map<std::string, std::string>& params)
 {
     if (instance == nullptr) {
         std::cout << "Singleton is not yet initialized.\n";
-        return std::make_pair("", "");
+        return request();
     }
     params["timestamp"] = RequestsHelper::getTimestamp();
-    RequestsHelper::signRequestHMAC(params, instance->apiKey_, instance->secretKey_);
 
-    std::string requestId = RequestsHelper::generateRequestId();
-    nlohmann::json requestBody = {
-        {"id", requestId},
-        {"method", method},
-        {"params", params}
-    };
-
-    return std::make_pair(requestId, requestBody.dump());
-}
-
-/*
-
-unsigned char* readPemToDer(const std::string &pemFilePath, int &derLen) {
-    // Open the PEM file
-    FILE *pemFile = fopen(pemFilePath.c_str(), "r");
-    if (!pemFile) {
-        throw std::runtime_error("Unable to open PEM file.");
-    }
-
-    // Read the private key from the PEM file
-    EVP_PKEY *pkey = PEM_read_PrivateKey(pemFile, nullptr, nullptr, nullptr);
-    fclose(pemFile);
-
-    if (!pkey) {
-        throw std::runtime_error("Failed to read private key from PEM file.");
+    char signature[MAX_SIGNATURE_CHARS];
+    size_t signatureChars = 0;
+    if (!isSessionAuthenticated()) {
+        signatureChars = signParams(params, signature);
     }
 
-    // Ensure the key is Ed25519
-    if (EVP_PKEY_base_id(pkey) != EVP_PKEY_ED25519) {
-        EVP_PKEY_free(pkey);
-        throw std::runtime_error("Not an Ed25519 key.");
-    }
-
-    // Convert the private key to DER format
-    derLen = i2d_PrivateKey(pkey, nullptr);  // Get the length of the DER key
-    if (derLen <= 0) {
-        EVP_PKEY_free(pkey);
-        throw std::runtime_error("Failed to determine DER key length.");
-    }
-
-    // Allocate memory for DER-encoded key
-    unsigned char *der = new unsigned char[derLen];
-
-    // Convert the key and store it in the buffer
-    unsigned char *derPtr = der;
-    if (i2d_PrivateKey(pkey, &derPtr) <= 0) {
-        EVP_PKEY_free(pkey);
-        delete[] der;
-        throw std::runtime_error("Failed to convert private key to DER.");
-    }
-
-    // Clean up
-    EVP_PKEY_free(pkey);
+    uint64_t requestId = RequestsHelper::nextRequestId();
+    return std::make_pair(requestId, writeBody(RequestsHelper::formatRequestId(requestId).view(), method, params, signature, signatureChars));
+}
 
-    return der;  // Return the DER-encoded key
+bool RequestsBuilder::needsSignature(const std::string& body)
+{
+    return body.find("\"timestamp\":") != std::string::npos && body.find("\"signature\":") == std::string::npos;
 }
 
-std::string sign_payload(const std::string& privateKey, const std::string& payload) {
-    unsigned char signature[crypto_sign_ed25519_BYTES];
-    unsigned long long signature_len;
-    int sizee;
-    const unsigned char* key = readPemToDer("/home/iyedexe/workbench/rtex/config/bnb_priv_ed25519.txt", sizee); 
-    LOG_WARNING("Signature : {}", std::string(reinterpret_cast<const char*>(key)));
-
-    if (crypto_sign_detached(
-        signature, &signature_len,
-        reinterpret_cast<const unsigned char*>(payload.c_str()), payload.size(),
-        key
-        ) != 0)
-    {
-        throw std::runtime_error("Failed to sign message");        
-    }
-    LOG_WARNING("Raw signature {}", std::string(reinterpret_cast<char*>(signature)));
-    
-    char base64_signature[crypto_sign_ed25519_BYTES * 2];
-    if (sodium_bin2base64(
-        base64_signature, sizeof(base64_signature),
-        signature, signature_len,
-        sodium_base64_VARIANT_ORIGINAL
-        ) != 0)
-    {
-        throw std::runtime_error("Failed to encode base64 key");        
+// Only on the way to a session that is not logged on, parsing costs more than building
+std::string RequestsBuilder::signRequest(const std::string& body)
+{
+    nlohmann::json json = nlohmann::json::parse(body);
+    std::map<std::string, std::string> params;
+    for (const auto& [key, value] : json.at("params").items()) {
+        params[key] = value.is_string() ? value.get<std::string>() : value.dump();
     }
-
-    return std::string(base64_signature);
+    char signature[MAX_SIGNATURE_CHARS];
+    size_t signatureChars = signParams(params, signature);
+    return writeBody(json.at("id").get<std::string>(), json.at("method").get<std::string>(), params, signature, signatureChars);
 }
 
+size_t RequestsBuilder::signParams(std::map<std::string, std::string>& params, char* signature)
+{
+    params.insert({"apiKey", instance->apiKey_});
+    thread_local std::string query;
+    query.clear();
+    RequestsHelper::appendQueryString(query, params);
+    return signPayload(query, signature);
+}
 
-std::string BNBRequests::generateED25519Signature(const std::string& secretKey, std::map<std::string, std::string>& params) {
-    if (sodium_init() < 0) {
-        throw std::runtime_error("Failed to initialize libsodium");
+std::string RequestsBuilder::writeBody(std::string_view id, const std::string& method, const std::map<std::string, std::string>& params,
+                                       const char* signature, size_t signatureChars)
+{
+    std::string body;
+    body.reserve(method.size() + 8 * params.size() + signatureChars + 160);
+    body += "{\"id\":";
+    RequestsHelper::appendJsonString(body, id);
+    body += ",\"method\":";
+    RequestsHelper::appendJsonString(body, method);
+    body += ",\"params\":{";
+    bool first = true;
+    for (const auto& [key, value] : params) {
+        if (!first) {
+            body += ',';
+        }
+        first = false;
+        RequestsHelper::appendJsonString(body, key);
+        body += ':';
+        RequestsHelper::appendJsonString(body, value);
     }
-    std::string payload = generatePayload(params);
-
-    std::string signature = sign_payload(secretKey, payload);
-    LOG_WARNING("Signature : {}", signature);
-    return signature;
+    if (signatureChars > 0) {
+        body += ",\"signature\":\"";
+        body.append(signature, signatureChars);
+        body += '"';
+    }
+    body += "}}";
+    return body;
 }
-*/
\ No newline at end of file
@@ -1,45 +1,93 @@
 #include "bnb/utils/BNBRequests/RequestsHelper.h"
+#include "common/ExchangeClock.h"
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <random>
 
-std::string RequestsHelper::generateED25519Signature(const std::string& secretKey, std::map<std::string, std::string>& params){
+namespace {
+    using SessionPrefix = std::array<char, RequestsHelper::REQUEST_ID_PREFIX_CHARS + 1>;
 
-}
-void RequestsHelper::signRequestHMAC(std::map<std::string, std::string>& params, const std::string& apiKey ,const std::string& secretKey){
-    // https://developers.binance.com/docs/binance-spot-api-docs/web-socket-api/public-websocket-api-for-binance#signed-request-example-hmac    
-    params.insert({"apiKey", apiKey});
-    std::string payload = generatePayload(params);
-    std::string signature = generateHMACSignature(secretKey, payload);
-    params.insert({"signature", signature});
-    return;
+    const SessionPrefix& sessionPrefix() {
+        static const SessionPrefix prefix = []() {
+            static constexpr char HEX[] = "0123456789abcdef";
+            std::random_device device;
+            uint32_t seed = device();
+            SessionPrefix text;
+            for (size_t i = 0; i < RequestsHelper::REQUEST_ID_PREFIX_CHARS; ++i) {
+                text[i] = HEX[(seed >> (4 * i)) & 0xf];
+            }
+            text[RequestsHelper::REQUEST_ID_PREFIX_CHARS] = '-';
+            return text;
+        }();
+        return prefix;
+    }
 
+    std::atomic<uint64_t> nextId{1};
 }
+
 std::string RequestsHelper::getTimestamp(){
-    auto now = std::chrono::system_clock::now();
-    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-    return std::to_string(milliseconds);
+    char buffer[20];
+    return std::string(buffer, writeTimestamp(buffer));
+}
+
+char* RequestsHelper::writeTimestamp(char* out){
+    return std::to_chars(out, out + 20, ExchangeClock::nowMs()).ptr;
+}
+
+uint64_t RequestsHelper::nextRequestId(){
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+RequestsHelper::RequestIdText RequestsHelper::formatRequestId(uint64_t id){
+    const SessionPrefix& prefix = sessionPrefix();
+    RequestIdText text;
+    std::memcpy(text.data, prefix.data(), prefix.size());
+    char* end = std::to_chars(text.data + prefix.size(), text.data + MAX_REQUEST_ID_CHARS, id).ptr;
+    text.size = end - text.data;
+    return text;
 }
 
-std::string RequestsHelper::generateRequestId(){
-    boost::uuids::uuid uuid = boost::uuids::random_generator()();
-    std::string requestId = boost::uuids::to_string(uuid);
-    return requestId;
+bool RequestsHelper::parseRequestId(std::string_view text, uint64_t& id){
+    const SessionPrefix& prefix = sessionPrefix();
+    if (text.size() <= prefix.size() || text.compare(0, prefix.size(), std::string_view(prefix.data(), prefix.size())) != 0) {
+        return false;
+    }
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data() + prefix.size(), end, id);
+    return ec == std::errc() && ptr == end;
 }
 
-std::string RequestsHelper::generateHMACSignature(const std::string& secretKey,const std::string& payload)
+void RequestsHelper::appendQueryString(std::string& out, const std::map<std::string, std::string>& params)
 {
-    unsigned char* digest;
-    digest = HMAC(EVP_sha256(), secretKey.c_str(), secretKey.length(), (unsigned char*)payload.c_str(), payload.length(), NULL, NULL);
-    char mdString[SHA256_DIGEST_LENGTH * 2 + 1];//TODO why sha length ?
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-        sprintf(&mdString[i * 2], "%02x", (unsigned int)digest[i]);
+    bool first = true;
+    for (const auto& [key, value] : params) {
+        if (!first) {
+            out += '&';
+        }
+        first = false;
+        out += key;
+        out += '=';
+        out += value;
     }
-    return std::string(mdString);
 }
 
-std::string RequestsHelper::generatePayload(const std::map<std::string, std::string>& params) {
-    std::vector<std::string> param_list;
-    
-    for (const auto& param : params) {
-        param_list.push_back(fmt::format("{}={}", param.first, param.second));
-    }    
-    return fmt::format("{}", fmt::join(param_list, "&"));
+void RequestsHelper::appendJsonString(std::string& out, std::string_view text)
+{
+    static constexpr char HEX[] = "0123456789abcdef";
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += "\\u00";
+            out += HEX[(c >> 4) & 0xf];
+            out += HEX[c & 0xf];
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
 }
\ No newline at end of file
@@ -2,33 +2,33 @@
 
 namespace BNBRequests
 {
-    request Trading::placeNewOrder(const std::string& symbol, Way side, OrderType type, double quantity, double price){
+    request Trading::placeNewOrder(const std::string& symbol, Way side, OrderType type, Qty quantity, Price price){
         std::map<std::string, std::string> params{
-                {"symbol", "symbol"},
+                {"symbol", symbol},
                 {"side", (side==Way::BUY) ? "BUY" : "SELL"},
                 {"type", (type==OrderType::MARKET) ? "MARKET" : "LIMIT"},
-                {"quantity", std::to_string(quantity)}
+                {"quantity", quantity.to_str()}
         };
-        if (price > 0)
+        if (price > Price())
         {
-            params["price"] = std::to_string(price);
+            params["price"] = price.to_str();
         }
       
         return RequestsBuilder::paramsSignedRequest("order.place", params);    
  
     }
 
-    request Trading::testNewOrder(const std::string& symbol, Way side, OrderType type, double quantity, double price){
+    request Trading::testNewOrder(const std::string& symbol, Way side, OrderType type, Qty quantity, Price price){
         std::map<std::string, std::string> params{
                 {"symbol", symbol},
                 {"side", (side==Way::BUY) ? "BUY" : "SELL"},
                 {"type", (type==OrderType::MARKET) ? "MARKET" : "LIMIT"},
-                {"quantity", std::to_string(quantity)},
+                {"quantity", quantity.to_str()},
                 {"computeCommissionRates", "true"}
         };
-        if (price > 0)
+        if (price > Price())
         {
-            params["price"] = std::to_string(price);
+            params["price"] = price.to_str();
         }
       
         return RequestsBuilder::paramsSignedRequest("order.test", params);    
@@ -37,7 +37,7 @@ namespace BNBRequests
 
     request Trading::cancelOrders(){
         throw std::runtime_error("[BNBREQUESTS] Not yet implemented");
-        return std::make_pair("", "");
+        return request();
     }
 }
 
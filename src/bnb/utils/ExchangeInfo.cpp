@@ -18,7 +18,8 @@ ExchangeInfo::ExchangeInfo(const json& jsonData) {
                     symbolJson["baseAsset"].get<std::string>(),
                     symbolJson["quoteAsset"].get<std::string>(),
                     symbolJson["symbol"].get<std::string>(),
-                    createSymbolFilter(symbolJson["filters"])
+                    createSymbolFilter(symbolJson["filters"]),
+                    static_cast<InstrumentId>(symbols_.size())
                 )
             );
         }
@@ -45,39 +46,39 @@ std::vector<Symbol> ExchangeInfo::getRelatedSymbols(std::string asset) const {
 }
 
 SymbolFilter ExchangeInfo::createSymbolFilter(const json& filterJson) const {
-    PriceFilter pf = {0, 0, 0};
-    LotSizeFilter lsf = {0, 0, 0};
-    MarketLotSizeFilter mlsf = {0, 0, 0};
-    NotionalFilter nf = {0, false, 0, false, 0};
-    MinNotionalFilter mnf = {0, false, 0};
-    MaxPositionFilter mpf = {0};
+    PriceFilter pf = {};
+    LotSizeFilter lsf = {};
+    MarketLotSizeFilter mlsf = {};
+    NotionalFilter nf = {Qty(), false, Qty(), false, 0};
+    MinNotionalFilter mnf = {Qty(), false, 0};
+    MaxPositionFilter mpf = {};
 
     for (const auto& filter : filterJson) {
         // LOG_DEBUG("Parsing filter {}, {}", filter["filterType"].get<std::string>(), filter.dump());
         if (filter["filterType"].get<std::string>() == "PRICE_FILTER") {
-            pf.maxPrice = std::stod(filter["maxPrice"].get<std::string>());
-            pf.minPrice = std::stod(filter["minPrice"].get<std::string>());
-            pf.tickSize = std::stod(filter["tickSize"].get<std::string>());
+            pf.maxPrice = Price::fromString(filter["maxPrice"].get<std::string>());
+            pf.minPrice = Price::fromString(filter["minPrice"].get<std::string>());
+            pf.tickSize = Price::fromString(filter["tickSize"].get<std::string>());
         } else if (filter["filterType"].get<std::string>() == "LOT_SIZE") {
-            lsf.minQty = std::stod(filter["minQty"].get<std::string>());
-            lsf.maxQty = std::stod(filter["maxQty"].get<std::string>());
-            lsf.stepSize = std::stod(filter["stepSize"].get<std::string>());
+            lsf.minQty = Qty::fromString(filter["minQty"].get<std::string>());
+            lsf.maxQty = Qty::fromString(filter["maxQty"].get<std::string>());
+            lsf.stepSize = Qty::fromString(filter["stepSize"].get<std::string>());
         } else if (filter["filterType"].get<std::string>() == "MARKET_LOT_SIZE") {
-            mlsf.minQty = std::stod(filter["minQty"].get<std::string>());
-            mlsf.maxQty = std::stod(filter["maxQty"].get<std::string>());
-            mlsf.stepSize = std::stod(filter["stepSize"].get<std::string>());
+            mlsf.minQty = Qty::fromString(filter["minQty"].get<std::string>());
+            mlsf.maxQty = Qty::fromString(filter["maxQty"].get<std::string>());
+            mlsf.stepSize = Qty::fromString(filter["stepSize"].get<std::string>());
         } else if (filter["filterType"].get<std::string>() == "NOTIONAL") {
-            nf.minNotional = std::stod(filter["minNotional"].get<std::string>());
+            nf.minNotional = Qty::fromString(filter["minNotional"].get<std::string>());
             nf.applyMinToMarket = filter["applyMinToMarket"].get<bool>();
-            nf.maxNotional = std::stod(filter["maxNotional"].get<std::string>());
+            nf.maxNotional = Qty::fromString(filter["maxNotional"].get<std::string>());
             nf.applyMaxToMarket = filter["applyMaxToMarket"].get<bool>();
             nf.avgPriceMins = filter["avgPriceMins"].get<int>();
         } else if (filter["filterType"].get<std::string>() == "MIN_NOTIONAL") {
-            mnf.minNotional = std::stod(filter["minNotional"].get<std::string>());
+            mnf.minNotional = Qty::fromString(filter["minNotional"].get<std::string>());
             mnf.applyToMarket = filter["applyToMarket"].get<bool>();
             mnf.avgPriceMins = std::stoi(filter["avgPriceMins"].get<std::string>());
         } else if (filter["filterType"].get<std::string>() == "MAX_POSITION") {
-            mpf.maxPosition = std::stod(filter["maxPosition"].get<std::string>());
+            mpf.maxPosition = Qty::fromString(filter["maxPosition"].get<std::string>());
         }
     }
 
@@ -0,0 +1,29 @@
+#include "bnb/utils/InstrumentRegistry.h"
+#include "fin/Symbol.h"
+#include <stdexcept>
+
+InstrumentRegistry::InstrumentRegistry(const std::vector<Symbol>& symbols) {
+    symbols_.reserve(symbols.size());
+    ids_.reserve(symbols.size());
+    for (const auto& symbol : symbols) {
+        if (add(symbol.to_str()) != symbol.getId()) {
+            throw std::runtime_error("[InstrumentRegistry] Instrument id mismatch for symbol : " + symbol.to_str());
+        }
+    }
+}
+
+InstrumentId InstrumentRegistry::add(const std::string& symbol) {
+    auto it = ids_.find(symbol);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    InstrumentId id = static_cast<InstrumentId>(symbols_.size());
+    symbols_.push_back(symbol);
+    ids_.emplace(symbol, id);
+    return id;
+}
+
+InstrumentId InstrumentRegistry::find(std::string_view symbol) const {
+    auto it = ids_.find(symbol);
+    return (it != ids_.end()) ? it->second : INVALID_INSTRUMENT_ID;
+}
@@ -0,0 +1,30 @@
+#include "common/ClockOffsetEstimator.h"
+#include <algorithm>
+
+bool ClockOffsetEstimator::addSample(uint64_t sendNs, uint64_t receiveNs, uint64_t exchangeMs) {
+    if (exchangeMs == 0 || receiveNs < sendNs) {
+        return false;
+    }
+    // The exchange truncates to the ms, its time lies anywhere in [ms, ms + 1)
+    int64_t exchangeNs = static_cast<int64_t>(exchangeMs * 1000000 + 500000);
+    int64_t midpointNs = static_cast<int64_t>(sendNs + (receiveNs - sendNs) / 2);
+    Sample sample{exchangeNs - midpointNs, receiveNs - sendNs};
+
+    if (samples_.size() < WINDOW) {
+        samples_.push_back(sample);
+    } else {
+        samples_[next_] = sample;
+    }
+    next_ = (next_ + 1) % WINDOW;
+    ++count_;
+    return true;
+}
+
+const ClockOffsetEstimator::Sample& ClockOffsetEstimator::best() const {
+    static const Sample none;
+    if (samples_.empty()) {
+        return none;
+    }
+    return *std::min_element(samples_.begin(), samples_.end(),
+                             [](const Sample& a, const Sample& b) { return a.rttNs < b.rttNs; });
+}
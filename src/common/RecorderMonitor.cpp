@@ -18,34 +18,119 @@ RecorderMonitor::RecorderMonitor(const std::string& date) :
             .Name("RecorderSubscribedInstruments")
             .Help("Number of subscribed instruments")
             .Register(*registry_)
+            .Add({})),
+    reconnectsGauge_(prometheus::BuildGauge()
+            .Name("RecorderFeederReconnectsTotal")
+            .Help("Feeder connections replaced after a loss or rotated")
+            .Register(*registry_)
+            .Add({})),
+    failedReconnectsGauge_(prometheus::BuildGauge()
+            .Name("RecorderFeederFailedReconnectsTotal")
+            .Help("Feeder replacement connections that failed to subscribe in time")
+            .Register(*registry_)
             .Add({}))
 {
     RegisterCollectable(registry_);
 }
 
 
-void RecorderMonitor::updateMetrics(double runTimeSeconds, double timeUntilStopSeconds, int subscribedInstruments, const std::string& instrument) {
+void RecorderMonitor::setInstrumentRegistry(const InstrumentRegistry& registry) {
+    instruments_ = &registry;
+    updatesCounters_.assign(registry.size(), nullptr);
+    pendingUpdates_.assign(registry.size(), 0);
+    dirtyInstruments_.clear();
+    dirtyInstruments_.reserve(registry.size());
+}
+
+void RecorderMonitor::updateMetrics(double runTimeSeconds, double timeUntilStopSeconds, int subscribedInstruments) {
 
     runTimeGauge_.Set(runTimeSeconds);
     timeUntilStopGauge_.Set(timeUntilStopSeconds);
     subscribedInstrumentsGauge_.Set(subscribedInstruments);
 
-    if (updatesCounterMap_.find(instrument) == updatesCounterMap_.end()) {
-        updatesCounterMap_[instrument] = &prometheus::BuildCounter()
-                                            .Name("RecorderInstrumentUpdatesTotal")
-                                            .Help("Total number of updates received for each instrument")
-                                            .Register(*registry_)
-                                            .Add({{"instrument", instrument}});
+    for (InstrumentId instrument : dirtyInstruments_) {
+        prometheus::Counter*& counter = updatesCounters_[instrument];
+        if (counter == nullptr) {
+            counter = &prometheus::BuildCounter()
+                        .Name("RecorderInstrumentUpdatesTotal")
+                        .Help("Total number of updates received for each instrument")
+                        .Register(*registry_)
+                        .Add({{"instrument", instruments_->getSymbol(instrument)}});
+        }
+        counter->Increment(static_cast<double>(pendingUpdates_[instrument]));
+        pendingUpdates_[instrument] = 0;
+    }
+    dirtyInstruments_.clear();
+}
+
+void RecorderMonitor::updateShardMetrics(const std::vector<uint64_t>& shardUpdates) {
+    while (shardUpdatesGauges_.size() < shardUpdates.size()) {
+        shardUpdatesGauges_.push_back(&prometheus::BuildGauge()
+                    .Name("RecorderShardUpdatesTotal")
+                    .Help("Total number of updates received on each feeder connection")
+                    .Register(*registry_)
+                    .Add({{"shard", std::to_string(shardUpdatesGauges_.size())}}));
+    }
+    for (size_t shard = 0; shard < shardUpdates.size(); ++shard) {
+        shardUpdatesGauges_[shard]->Set(static_cast<double>(shardUpdates[shard]));
+    }
+}
+
+void RecorderMonitor::updateLegMetrics(const std::vector<uint64_t>& legWins, uint64_t duplicates) {
+    while (legWinsGauges_.size() < legWins.size()) {
+        legWinsGauges_.push_back(&prometheus::BuildGauge()
+                    .Name("RecorderLegWinsTotal")
+                    .Help("Total number of updates first received on each redundant feeder leg")
+                    .Register(*registry_)
+                    .Add({{"leg", std::string(1, static_cast<char>('A' + legWinsGauges_.size()))}}));
+    }
+    if (duplicatesGauge_ == nullptr) {
+        duplicatesGauge_ = &prometheus::BuildGauge()
+                    .Name("RecorderDuplicateUpdatesTotal")
+                    .Help("Total number of duplicate or stale updates dropped by leg arbitration")
+                    .Register(*registry_)
+                    .Add({});
+    }
+    for (size_t leg = 0; leg < legWins.size(); ++leg) {
+        legWinsGauges_[leg]->Set(static_cast<double>(legWins[leg]));
+    }
+    duplicatesGauge_->Set(static_cast<double>(duplicates));
+}
+
+void RecorderMonitor::updateLatencyMetrics(const std::string& stream, const std::string& stage, const LatencyHistogram& histogram) {
+    static const std::array<std::string, 4> quantiles = {"0.5", "0.99", "0.999", "max"};
+    auto it = latencyGauges_.find(stream + "/" + stage);
+    if (it == latencyGauges_.end()) {
+        auto& family = prometheus::BuildGauge()
+                    .Name("RecorderLatencyNanoseconds")
+                    .Help("Market data latency per stream type and stage (feed, parse, queue)")
+                    .Register(*registry_);
+        std::array<prometheus::Gauge*, 4> gauges;
+        for (size_t i = 0; i < quantiles.size(); ++i) {
+            gauges[i] = &family.Add({{"stream", stream}, {"stage", stage}, {"quantile", quantiles[i]}});
+        }
+        it = latencyGauges_.emplace(stream + "/" + stage, gauges).first;
     }
-    updatesCounterMap_[instrument]->Increment();
+    it->second[0]->Set(static_cast<double>(histogram.percentile(0.5)));
+    it->second[1]->Set(static_cast<double>(histogram.percentile(0.99)));
+    it->second[2]->Set(static_cast<double>(histogram.percentile(0.999)));
+    it->second[3]->Set(static_cast<double>(histogram.max()));
+}
+
+void RecorderMonitor::updateReconnectMetrics(uint64_t reconnects, uint64_t failedReconnects) {
+    reconnectsGauge_.Set(static_cast<double>(reconnects));
+    failedReconnectsGauge_.Set(static_cast<double>(failedReconnects));
 }
 
 int RecorderMonitor::getUpdatesCount()
 {
     int updatesCount = 0;
-    for (auto const& it: updatesCounterMap_)
+    for (auto const* counter: updatesCounters_)
     {
-        updatesCount+= it.second->Value();
+        if (counter != nullptr)
+        {
+            updatesCount+= counter->Value();
+        }
     }
     return updatesCount;
 }
\ No newline at end of file
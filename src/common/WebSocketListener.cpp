@@ -2,6 +2,9 @@
 #include "common/WebSocketListener.h"
 #include <websocketpp/client.hpp>
 #include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
 
 std::shared_ptr<sslcontext> WebSocketListener::on_tls_init() {
   auto ctx = std::make_shared<sslcontext>(
@@ -15,6 +18,7 @@ WebSocketListener::WebSocketListener() {
 
     tls_client_.init_asio();
     tls_client_.set_tls_init_handler(websocketpp::lib::bind(&WebSocketListener::on_tls_init, this));    
+    tls_client_.set_socket_init_handler(websocketpp::lib::bind(&WebSocketListener::onSocketInit, this, websocketpp::lib::placeholders::_1, websocketpp::lib::placeholders::_2));
     tls_client_.set_open_handler(websocketpp::lib::bind(&WebSocketListener::onOpen, this, websocketpp::lib::placeholders::_1));
     tls_client_.set_close_handler(websocketpp::lib::bind(&WebSocketListener::onClose, this, websocketpp::lib::placeholders::_1));
     tls_client_.set_fail_handler(websocketpp::lib::bind(&WebSocketListener::onFail, this, websocketpp::lib::placeholders::_1));
@@ -39,10 +43,10 @@ void WebSocketListener::connect(const std::string& uri) {
 void WebSocketListener::writeWS(const std::string& message){
     try 
     {
-        if (~isConnected_) // gain speed by not locking if already connected
+        if (!isConnected_) // gain speed by not locking if already connected
         {
             std::unique_lock<std::mutex> lock(connectionMutex_);
-            connectionCond_.wait(lock, [this] { return isConnected_; });
+            connectionCond_.wait(lock, [this] { return isConnected_.load(); });
         }
 
         LOG_DEBUG("[WSListener][SEND] Sending over WS {}", message);
@@ -52,12 +56,89 @@ void WebSocketListener::writeWS(const std::string& message){
     }
 }
 
+bool WebSocketListener::tryWriteWS(const std::string& message) {
+    if (!isConnected_) {
+        return false;
+    }
+    websocketpp::lib::error_code ec;
+    LOG_DEBUG("[WSListener][SEND] Sending over WS {}", message);
+    tls_client_.send(hdl_, message, websocketpp::frame::opcode::text, ec);
+    if (ec) {
+        LOG_ERROR("[WSListener][SEND] Error while writing on WS message :[{}]: {}", message, ec.message());
+        return false;
+    }
+    return true;
+}
+
+wsppclient::timer_ptr WebSocketListener::setTimer(long durationMs, websocketpp::transport::timer_handler handler) {
+    return tls_client_.set_timer(durationMs, handler);
+}
+
+void WebSocketListener::onSocketInit(websocketpp::connection_hdl hdl, websocketpp::lib::asio::ssl::stream<websocketpp::lib::asio::ip::tcp::socket>& socket) {
+    auto& tcpSocket = socket.lowest_layer();
+    websocketpp::lib::asio::error_code ec;
+    tcpSocket.set_option(websocketpp::lib::asio::ip::tcp::no_delay(options_.tcpNoDelay), ec);
+    if (ec) {
+        LOG_WARNING("[WSListener][SOCKET_INIT] Could not set TCP_NODELAY: {}", ec.message());
+    }
+    if (options_.rcvBufBytes > 0) {
+        tcpSocket.set_option(websocketpp::lib::asio::socket_base::receive_buffer_size(options_.rcvBufBytes), ec);
+        if (ec) {
+            LOG_WARNING("[WSListener][SOCKET_INIT] Could not set SO_RCVBUF to {}: {}", options_.rcvBufBytes, ec.message());
+        }
+    }
+#ifdef SO_BUSY_POLL
+    if (options_.soBusyPollUs > 0) {
+        int busyPollUs = options_.soBusyPollUs;
+        if (setsockopt(tcpSocket.native_handle(), SOL_SOCKET, SO_BUSY_POLL, &busyPollUs, sizeof(busyPollUs)) != 0) {
+            LOG_WARNING("[WSListener][SOCKET_INIT] Could not set SO_BUSY_POLL to {}us (needs CAP_NET_ADMIN above net.core.busy_read)", busyPollUs);
+        }
+    }
+#endif
+}
+
 void WebSocketListener::startClient() {
     LOG_INFO("[WSListener][START_CLIENT] Running client on {}:{}{}", con_->get_host(), con_->get_port() ,con_->get_resource());
-    tls_client_.run();
+    if (options_.cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(options_.cpu, &cpuset);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+        if (rc != 0) {
+            LOG_WARNING("[WSListener][START_CLIENT] Could not pin io thread to cpu {}: {}", options_.cpu, rc);
+        } else {
+            LOG_INFO("[WSListener][START_CLIENT] io thread pinned to cpu {}", options_.cpu);
+        }
+    }
+    if (!options_.busyPoll) {
+        tls_client_.run();
+        return;
+    }
+
+    // Never sleeps in epoll, handlers run as soon as the socket is readable.
+    // Counters only have this thread as writer, plain stores avoid locked adds.
+    LOG_INFO("[WSListener][START_CLIENT] Busy polling the io context");
+    uint64_t iterations = pollIterations_.load(std::memory_order_relaxed);
+    uint64_t idle = pollIdleIterations_.load(std::memory_order_relaxed);
+    while (!tls_client_.stopped()) {
+        if (tls_client_.poll() == 0) {
+            pollIdleIterations_.store(++idle, std::memory_order_relaxed);
+        }
+        pollIterations_.store(++iterations, std::memory_order_relaxed);
+    }
 }
 
 
+// A previous stopClient leaves the io context stopped. Reset by the owner before the io
+// thread starts, a reset on the io thread would clear a stopClient that came first.
+void WebSocketListener::resetClient() {
+    tls_client_.reset();
+}
+
+void WebSocketListener::keepRunning() {
+    tls_client_.start_perpetual();
+}
+
 void WebSocketListener::stopClient() {
     tls_client_.stop();
 }
@@ -72,6 +153,10 @@ void WebSocketListener::onOpen(websocketpp::connection_hdl hdl) {
 
 void WebSocketListener::onClose(websocketpp::connection_hdl hdl) {
     LOG_INFO("[WSListener][ON_CLOSE] WebSocket connection closed.");
+    {
+        std::unique_lock<std::mutex> lock(connectionMutex_);
+        isConnected_ = false;
+    }
     std::string m_server = con_->get_response_header("Server");
     std::string m_error_reason = con_->get_ec().message();
 
@@ -81,6 +166,10 @@ void WebSocketListener::onClose(websocketpp::connection_hdl hdl) {
 
 void WebSocketListener::onFail(websocketpp::connection_hdl hdl) {
     LOG_INFO("[WSListener][ON_FAIL] WebSocket connection failed.");
+    {
+        std::unique_lock<std::mutex> lock(connectionMutex_);
+        isConnected_ = false;
+    }
     std::string m_server = con_->get_response_header("Server");
     std::string m_error_reason = con_->get_ec().message();
 
@@ -0,0 +1,646 @@
+#include "mock/MockExchange.h"
+#include "common/logger.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <fstream>
+
+namespace {
+    constexpr int64_t BOOK_LEVELS = 20;
+    const std::vector<std::string> QUOTE_ASSETS = {"FDUSD", "USDT", "USDC", "BUSD", "TUSD", "BTC", "ETH", "BNB", "EUR", "TRY"};
+
+    uint64_t nowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::string lowercase(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+        return text;
+    }
+
+    // Four to five significant digits per tick, as on most Binance spot pairs
+    Price tickSizeFor(double price) {
+        Price tick = Price::fromDouble(std::pow(10.0, std::floor(std::log10(price)) - 4));
+        return tick.isZero() ? Price::fromRaw(1) : tick;
+    }
+
+    bool sameConnection(const websocketpp::connection_hdl& a, const websocketpp::connection_hdl& b) {
+        return !a.owner_before(b) && !b.owner_before(a);
+    }
+}
+
+MockExchange::MockExchange(const MockExchangeConfig& config) :
+    config_(config),
+    rng_(config.seed) {
+    tls_context_ = std::make_shared<sslcontext>(sslcontext::tls_server);
+    tls_context_->set_options(sslcontext::default_workarounds | sslcontext::no_sslv2 | sslcontext::no_sslv3 | sslcontext::single_dh_use);
+    tls_context_->use_certificate_chain_file(config_.certificateFile);
+    tls_context_->use_private_key_file(config_.privateKeyFile, sslcontext::pem);
+
+    server_.clear_access_channels(websocketpp::log::alevel::all);
+    server_.clear_error_channels(websocketpp::log::elevel::all);
+    server_.init_asio();
+    server_.set_reuse_addr(true);
+    server_.set_tls_init_handler(websocketpp::lib::bind(&MockExchange::onTlsInit, this, websocketpp::lib::placeholders::_1));
+    server_.set_open_handler(websocketpp::lib::bind(&MockExchange::onOpen, this, websocketpp::lib::placeholders::_1));
+    server_.set_close_handler(websocketpp::lib::bind(&MockExchange::onClose, this, websocketpp::lib::placeholders::_1));
+    server_.set_message_handler(websocketpp::lib::bind(&MockExchange::onMessage, this, websocketpp::lib::placeholders::_1, websocketpp::lib::placeholders::_2));
+
+    std::uniform_int_distribution<int64_t> lots(1, 1000);
+    for (const auto& [symbol, startPrice] : config_.symbols) {
+        Instrument instrument;
+        instrument.symbol = symbol;
+        instrument.quoteAsset = symbol.substr(symbol.size() - std::min<size_t>(3, symbol.size()));
+        for (const auto& quote : QUOTE_ASSETS) {
+            if (symbol.size() > quote.size() && symbol.compare(symbol.size() - quote.size(), quote.size(), quote) == 0) {
+                instrument.quoteAsset = quote;
+                break;
+            }
+        }
+        instrument.baseAsset = symbol.substr(0, symbol.size() - instrument.quoteAsset.size());
+        instrument.bookTickerStream = lowercase(symbol) + "@bookTicker";
+        instrument.aggTradeStream = lowercase(symbol) + "@aggTrade";
+        instrument.depthStream = lowercase(symbol) + "@depth@100ms";
+
+        double price = startPrice;
+        if (!config_.replayDir.empty()) {
+            loadReplay(instrument);
+            if (!instrument.replay.empty()) {
+                price = instrument.replay.front().bidPrice.toDouble();
+            }
+        }
+        instrument.tickSize = tickSizeFor(price);
+        instrument.midTick = static_cast<int64_t>(std::llround(price / instrument.tickSize.toDouble()));
+        for (int64_t level = 1; level <= BOOK_LEVELS; ++level) {
+            instrument.bids[instrument.midTick - level] = lots(rng_) * Qty::SCALE / 100;
+            instrument.asks[instrument.midTick + level] = lots(rng_) * Qty::SCALE / 100;
+        }
+        instrument_index_[symbol] = instruments_.size();
+        instruments_.push_back(std::move(instrument));
+    }
+}
+
+void MockExchange::run() {
+    server_.listen(config_.listenPort);
+    server_.start_accept();
+
+    tick_timer_ = std::make_unique<websocketpp::lib::asio::steady_timer>(server_.get_io_service(), std::chrono::steady_clock::now());
+    scheduleTick();
+
+    websocketpp::lib::asio::signal_set signals(server_.get_io_service(), SIGINT, SIGTERM);
+    signals.async_wait([this](const websocketpp::lib::asio::error_code&, int) {
+        LOG_INFO("[MOCK_EXCHANGE] Stopping, {} messages sent", messages_sent_);
+        tick_timer_->cancel();
+        server_.stop_listening();
+        server_.stop();
+    });
+
+    LOG_INFO("[MOCK_EXCHANGE] Listening on port {}, {} symbols, {} events/s per symbol{}", config_.listenPort, instruments_.size(), config_.eventRateHz,
+        config_.replayDir.empty() ? "" : ", replaying " + config_.replayDir + " " + config_.replayDate);
+    server_.run();
+}
+
+std::shared_ptr<MockExchange::sslcontext> MockExchange::onTlsInit(websocketpp::connection_hdl) {
+    return tls_context_;
+}
+
+void MockExchange::onOpen(websocketpp::connection_hdl hdl) {
+    std::string resource = server_.get_con_from_hdl(hdl)->get_resource();
+    Session& session = sessions_[hdl];
+    if (resource.rfind("/ws-api", 0) == 0) {
+        session.channel = Session::Channel::API;
+    } else if (resource.rfind("/stream", 0) == 0) {
+        session.channel = Session::Channel::COMBINED_STREAM;
+        // /stream?streams=a/b/c
+        size_t query = resource.find("streams=");
+        if (query != std::string::npos) {
+            std::stringstream streams(resource.substr(query + 8));
+            std::string stream;
+            while (std::getline(streams, stream, '/')) {
+                subscribe(hdl, session, stream);
+            }
+        }
+    } else {
+        session.channel = Session::Channel::STREAM;
+        // /ws/<stream>
+        if (resource.size() > 4 && resource.rfind("/ws/", 0) == 0) {
+            subscribe(hdl, session, resource.substr(4));
+        }
+    }
+    LOG_INFO("[MOCK_EXCHANGE] Connection opened on {}, {} sessions", resource, sessions_.size());
+}
+
+void MockExchange::onClose(websocketpp::connection_hdl hdl) {
+    auto it = sessions_.find(hdl);
+    if (it == sessions_.end()) {
+        return;
+    }
+    std::vector<std::string> streams = it->second.streams;
+    for (const auto& stream : streams) {
+        unsubscribe(hdl, it->second, stream);
+    }
+    sessions_.erase(it);
+    LOG_INFO("[MOCK_EXCHANGE] Connection closed, {} sessions", sessions_.size());
+}
+
+void MockExchange::onMessage(websocketpp::connection_hdl hdl, server::message_ptr msg) {
+    auto it = sessions_.find(hdl);
+    if (it == sessions_.end()) {
+        return;
+    }
+    if (it->second.channel == Session::Channel::API) {
+        onApiRequest(hdl, msg->get_payload());
+    } else {
+        onStreamRequest(hdl, it->second, msg->get_payload());
+    }
+}
+
+void MockExchange::onStreamRequest(websocketpp::connection_hdl hdl, Session& session, const std::string& payload) {
+    nlohmann::json request;
+    try {
+        request = nlohmann::json::parse(payload);
+    } catch (const std::exception&) {
+        send(hdl, R"({"error":{"code":3,"msg":"Invalid JSON"},"id":null})");
+        return;
+    }
+    nlohmann::json response = {{"id", request.contains("id") ? request["id"] : nlohmann::json()}};
+    std::string method = request.value("method", "");
+    if (method == "SUBSCRIBE" || method == "UNSUBSCRIBE") {
+        for (const auto& stream : request.value("params", nlohmann::json::array())) {
+            if (method == "SUBSCRIBE") {
+                subscribe(hdl, session, stream.get<std::string>());
+            } else {
+                unsubscribe(hdl, session, stream.get<std::string>());
+            }
+        }
+        response["result"] = nullptr;
+    } else if (method == "LIST_SUBSCRIPTIONS") {
+        response["result"] = session.streams;
+    } else {
+        response["error"] = {{"code", 2}, {"msg", "Invalid request: unknown method " + method}};
+    }
+    send(hdl, response.dump());
+}
+
+void MockExchange::subscribe(websocketpp::connection_hdl hdl, Session& session, const std::string& stream) {
+    if (std::find(session.streams.begin(), session.streams.end(), stream) != session.streams.end()) {
+        return;
+    }
+    session.streams.push_back(stream);
+    subscribers_[stream].push_back(Subscriber{hdl, session.channel == Session::Channel::COMBINED_STREAM});
+}
+
+void MockExchange::unsubscribe(websocketpp::connection_hdl hdl, Session& session, const std::string& stream) {
+    session.streams.erase(std::remove(session.streams.begin(), session.streams.end(), stream), session.streams.end());
+    auto it = subscribers_.find(stream);
+    if (it == subscribers_.end()) {
+        return;
+    }
+    auto& subscribers = it->second;
+    subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+        [&hdl](const Subscriber& subscriber) { return sameConnection(subscriber.hdl, hdl); }), subscribers.end());
+}
+
+void MockExchange::onApiRequest(websocketpp::connection_hdl hdl, const std::string& payload) {
+    nlohmann::json response;
+    try {
+        nlohmann::json request = nlohmann::json::parse(payload);
+        response["id"] = request.contains("id") ? request["id"] : nlohmann::json();
+        response["status"] = 200;
+        response["result"] = handleApi(request.value("method", ""), request.value("params", nlohmann::json::object()));
+        response["rateLimits"] = nlohmann::json::array();
+    } catch (const ApiError& e) {
+        response.erase("result");
+        response["status"] = 400;
+        response["error"] = {{"code", e.code}, {"msg", e.what()}};
+    } catch (const std::exception& e) {
+        response.erase("result");
+        response["status"] = 400;
+        response["error"] = {{"code", -1000}, {"msg", e.what()}};
+    }
+
+    uint32_t delayUs = config_.apiLatencyUs;
+    if (config_.apiLatencyJitterUs > 0) {
+        delayUs += std::uniform_int_distribution<uint32_t>(0, config_.apiLatencyJitterUs)(rng_);
+    }
+    if (delayUs == 0) {
+        send(hdl, response.dump());
+        return;
+    }
+    auto timer = std::make_shared<websocketpp::lib::asio::steady_timer>(server_.get_io_service(), std::chrono::microseconds(delayUs));
+    timer->async_wait([this, timer, hdl, body = response.dump()](const websocketpp::lib::asio::error_code& ec) {
+        if (!ec) {
+            send(hdl, body);
+        }
+    });
+}
+
+nlohmann::json MockExchange::handleApi(const std::string& method, const nlohmann::json& params) {
+    if (method == "ping") {
+        return nlohmann::json::object();
+    } else if (method == "time") {
+        return {{"serverTime", nowMs()}};
+    } else if (method == "exchangeInfo") {
+        return exchangeInfo(params);
+    } else if (method == "session.logon") {
+        uint64_t now = nowMs();
+        return {{"apiKey", params.value("apiKey", "")}, {"authorizedSince", now}, {"connectedSince", now}, {"returnRateLimits", false}, {"serverTime", now}};
+    } else if (method == "account.status") {
+        return accountStatus();
+    } else if (method == "ticker.book") {
+        return bookTicker(params);
+    } else if (method == "depth") {
+        return depth(params);
+    } else if (method == "order.test") {
+        return placeOrder(params, true);
+    } else if (method == "order.place") {
+        return placeOrder(params, false);
+    }
+    throw ApiError(-1000, "Method not supported by the mock exchange: " + method);
+}
+
+nlohmann::json MockExchange::exchangeInfo(const nlohmann::json& params) {
+    std::vector<std::string> symbols;
+    if (params.contains("symbols")) {
+        symbols = params["symbols"].get<std::vector<std::string>>();
+    } else if (params.contains("symbol")) {
+        symbols.push_back(params["symbol"].get<std::string>());
+    } else {
+        for (const auto& instrument : instruments_) {
+            symbols.push_back(instrument.symbol);
+        }
+    }
+
+    nlohmann::json symbolsJson = nlohmann::json::array();
+    for (const auto& symbol : symbols) {
+        const Instrument& instrument = findInstrument(symbol);
+        std::string tick = instrument.tickSize.to_str();
+        symbolsJson.push_back({
+            {"symbol", instrument.symbol},
+            {"status", "TRADING"},
+            {"baseAsset", instrument.baseAsset},
+            {"baseAssetPrecision", 8},
+            {"quoteAsset", instrument.quoteAsset},
+            {"quotePrecision", 8},
+            {"quoteAssetPrecision", 8},
+            {"orderTypes", {"LIMIT", "MARKET"}},
+            {"filters", {
+                {{"filterType", "PRICE_FILTER"}, {"minPrice", tick}, {"maxPrice", "1000000"}, {"tickSize", tick}},
+                {{"filterType", "LOT_SIZE"}, {"minQty", "0.00001"}, {"maxQty", "9000"}, {"stepSize", "0.00001"}},
+                {{"filterType", "MARKET_LOT_SIZE"}, {"minQty", "0"}, {"maxQty", "9000"}, {"stepSize", "0"}},
+                {{"filterType", "NOTIONAL"}, {"minNotional", "0.0001"}, {"applyMinToMarket", true}, {"maxNotional", "9000000"}, {"applyMaxToMarket", false}, {"avgPriceMins", 5}}
+            }}
+        });
+    }
+    return {
+        {"timezone", "UTC"},
+        {"serverTime", nowMs()},
+        {"rateLimits", nlohmann::json::array()},
+        {"exchangeFilters", nlohmann::json::array()},
+        {"symbols", symbolsJson}
+    };
+}
+
+nlohmann::json MockExchange::accountStatus() {
+    nlohmann::json balances = nlohmann::json::array();
+    for (const auto& [asset, amount] : config_.balances) {
+        balances.push_back({{"asset", asset}, {"free", Qty::fromDouble(amount).to_str()}, {"locked", "0"}});
+    }
+    return {
+        {"makerCommission", 10},
+        {"takerCommission", 10},
+        {"canTrade", true},
+        {"canWithdraw", false},
+        {"canDeposit", false},
+        {"updateTime", nowMs()},
+        {"accountType", "SPOT"},
+        {"balances", balances},
+        {"permissions", {"SPOT"}}
+    };
+}
+
+nlohmann::json MockExchange::bookTicker(const nlohmann::json& params) {
+    auto ticker = [this](const Instrument& instrument) {
+        bool hasBid = !instrument.bids.empty();
+        bool hasAsk = !instrument.asks.empty();
+        return nlohmann::json{
+            {"symbol", instrument.symbol},
+            {"bidPrice", hasBid ? price(instrument, instrument.bids.rbegin()->first) : "0"},
+            {"bidQty", hasBid ? Qty::fromRaw(instrument.bids.rbegin()->second).to_str() : "0"},
+            {"askPrice", hasAsk ? price(instrument, instrument.asks.begin()->first) : "0"},
+            {"askQty", hasAsk ? Qty::fromRaw(instrument.asks.begin()->second).to_str() : "0"}
+        };
+    };
+    if (params.contains("symbol")) {
+        return ticker(findInstrument(params["symbol"].get<std::string>()));
+    }
+    nlohmann::json tickers = nlohmann::json::array();
+    if (params.contains("symbols")) {
+        for (const auto& symbol : params["symbols"]) {
+            tickers.push_back(ticker(findInstrument(symbol.get<std::string>())));
+        }
+    } else {
+        for (const auto& instrument : instruments_) {
+            tickers.push_back(ticker(instrument));
+        }
+    }
+    return tickers;
+}
+
+nlohmann::json MockExchange::depth(const nlohmann::json& params) {
+    const Instrument& instrument = findInstrument(params.value("symbol", ""));
+    size_t limit = std::clamp<size_t>(params.value("limit", 100), 1, 5000);
+    nlohmann::json bids = nlohmann::json::array();
+    for (auto it = instrument.bids.rbegin(); it != instrument.bids.rend() && bids.size() < limit; ++it) {
+        bids.push_back({price(instrument, it->first), Qty::fromRaw(it->second).to_str()});
+    }
+    nlohmann::json asks = nlohmann::json::array();
+    for (auto it = instrument.asks.begin(); it != instrument.asks.end() && asks.size() < limit; ++it) {
+        asks.push_back({price(instrument, it->first), Qty::fromRaw(it->second).to_str()});
+    }
+    return {{"lastUpdateId", instrument.updateId}, {"bids", bids}, {"asks", asks}};
+}
+
+// Marketable orders fill in full at the touch, others rest as NEW (never filled later).
+nlohmann::json MockExchange::placeOrder(const nlohmann::json& params, bool test) {
+    const Instrument& instrument = findInstrument(params.value("symbol", ""));
+    std::string side = params.value("side", "");
+    std::string type = params.value("type", "");
+    if ((side != "BUY" && side != "SELL") || (type != "LIMIT" && type != "MARKET")) {
+        throw ApiError(-1102, "Mandatory parameter side or type was not sent, was empty/null, or malformed.");
+    }
+    Qty quantity = Qty::fromString(params.value("quantity", "0"));
+    Price limitPrice = Price::fromString(params.value("price", "0"));
+
+    if (test) {
+        if (params.value("computeCommissionRates", "false") != "true") {
+            return nlohmann::json::object();
+        }
+        return {
+            {"standardCommissionForOrder", {{"maker", "0.001"}, {"taker", "0.001"}}},
+            {"taxCommissionForOrder", {{"maker", "0"}, {"taker", "0"}}},
+            {"discount", {{"enabledForAccount", false}, {"enabledForSymbol", false}, {"discountAsset", "BNB"}, {"discount", "0"}}}
+        };
+    }
+
+    bool buy = (side == "BUY");
+    const Book& opposite = buy ? instrument.asks : instrument.bids;
+    bool filled = false;
+    Price fillPrice;
+    if (!opposite.empty()) {
+        int64_t touch = buy ? opposite.begin()->first : opposite.rbegin()->first;
+        fillPrice = Price::fromRaw(touch * instrument.tickSize.raw());
+        filled = (type == "MARKET") || (buy ? limitPrice >= fillPrice : limitPrice <= fillPrice);
+    }
+
+    uint64_t now = nowMs();
+    uint64_t orderId = order_id_++;
+    nlohmann::json fills = nlohmann::json::array();
+    if (filled) {
+        fills.push_back({{"price", fillPrice.to_str()}, {"qty", quantity.to_str()}, {"commission", "0"}, {"commissionAsset", "BNB"}, {"tradeId", orderId}});
+    }
+    return {
+        {"symbol", instrument.symbol},
+        {"orderId", orderId},
+        {"orderListId", -1},
+        {"clientOrderId", params.value("newClientOrderId", "mock" + std::to_string(orderId))},
+        {"transactTime", now},
+        {"price", limitPrice.to_str()},
+        {"origQty", quantity.to_str()},
+        {"executedQty", filled ? quantity.to_str() : "0"},
+        {"cummulativeQuoteQty", filled ? notional(fillPrice, quantity).to_str() : "0"},
+        {"status", filled ? "FILLED" : "NEW"},
+        {"timeInForce", params.value("timeInForce", "GTC")},
+        {"type", type},
+        {"side", side},
+        {"workingTime", now},
+        {"selfTradePreventionMode", "NONE"},
+        {"fills", fills}
+    };
+}
+
+void MockExchange::scheduleTick() {
+    tick_timer_->expires_at(tick_timer_->expiry() + std::chrono::milliseconds(1));
+    tick_timer_->async_wait([this](const websocketpp::lib::asio::error_code& ec) {
+        if (ec) {
+            return;
+        }
+        onTick();
+        scheduleTick();
+    });
+}
+
+// 1ms tick, events are spread with a fractional budget so any rate is kept on average
+void MockExchange::onTick() {
+    uint64_t now = nowMs();
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (auto& instrument : instruments_) {
+        instrument.eventBudget += config_.eventRateHz / 1000.0;
+        while (instrument.eventBudget >= 1.0) {
+            instrument.eventBudget -= 1.0;
+            if (instrument.replay.empty()) {
+                generateEvent(instrument);
+            } else {
+                replayEvent(instrument);
+            }
+            publishBookTicker(instrument, now);
+            if (unit(rng_) < config_.tradeRatio) {
+                publishTrade(instrument, now);
+            }
+        }
+        if (ticks_ % 100 == 0) {
+            publishDepth(instrument, now);
+        }
+    }
+    if (++ticks_ % 10000 == 0) {
+        LOG_INFO("[MOCK_EXCHANGE] {} sessions, {} messages sent", sessions_.size(), messages_sent_);
+    }
+}
+
+// Random walk of the mid with one level change per event, the book stays uncrossed
+void MockExchange::generateEvent(Instrument& instrument) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<int64_t> lots(1, 1000);
+    ++instrument.updateId;
+
+    if (unit(rng_) < 0.3) {
+        instrument.midTick += (unit(rng_) < 0.5) ? -1 : 1;
+    }
+    int64_t mid = instrument.midTick;
+    while (!instrument.bids.empty() && instrument.bids.rbegin()->first >= mid) {
+        setLevel(instrument, true, instrument.bids.rbegin()->first, 0);
+    }
+    while (!instrument.asks.empty() && instrument.asks.begin()->first <= mid) {
+        setLevel(instrument, false, instrument.asks.begin()->first, 0);
+    }
+    if (instrument.bids.empty() || instrument.bids.rbegin()->first < mid - 1) {
+        setLevel(instrument, true, mid - 1, lots(rng_) * Qty::SCALE / 100);
+    }
+    if (instrument.asks.empty() || instrument.asks.begin()->first > mid + 1) {
+        setLevel(instrument, false, mid + 1, lots(rng_) * Qty::SCALE / 100);
+    }
+
+    bool bid = unit(rng_) < 0.5;
+    int64_t offset = std::uniform_int_distribution<int64_t>(1, BOOK_LEVELS)(rng_);
+    setLevel(instrument, bid, bid ? mid - offset : mid + offset, unit(rng_) < 0.2 ? 0 : lots(rng_) * Qty::SCALE / 100);
+
+    while (!instrument.bids.empty() && instrument.bids.begin()->first < mid - 2 * BOOK_LEVELS) {
+        setLevel(instrument, true, instrument.bids.begin()->first, 0);
+    }
+    while (!instrument.asks.empty() && instrument.asks.rbegin()->first > mid + 2 * BOOK_LEVELS) {
+        setLevel(instrument, false, instrument.asks.rbegin()->first, 0);
+    }
+}
+
+// Recorded top of book, levels better than the recorded touch are removed
+void MockExchange::replayEvent(Instrument& instrument) {
+    const Quote& quote = instrument.replay[instrument.replayPosition];
+    instrument.replayPosition = (instrument.replayPosition + 1) % instrument.replay.size();
+    ++instrument.updateId;
+
+    int64_t bidTick = quote.bidPrice.raw() / instrument.tickSize.raw();
+    int64_t askTick = quote.askPrice.raw() / instrument.tickSize.raw();
+    while (!instrument.bids.empty() && instrument.bids.rbegin()->first > bidTick) {
+        setLevel(instrument, true, instrument.bids.rbegin()->first, 0);
+    }
+    while (!instrument.asks.empty() && instrument.asks.begin()->first < askTick) {
+        setLevel(instrument, false, instrument.asks.begin()->first, 0);
+    }
+    setLevel(instrument, true, bidTick, quote.bidQty.raw());
+    setLevel(instrument, false, askTick, quote.askQty.raw());
+    instrument.midTick = (bidTick + askTick) / 2;
+}
+
+void MockExchange::setLevel(Instrument& instrument, bool bid, int64_t tick, int64_t qty) {
+    Book& book = bid ? instrument.bids : instrument.asks;
+    if (qty == 0) {
+        book.erase(tick);
+    } else {
+        book[tick] = qty;
+    }
+    if (instrument.firstPendingId == 0) {
+        instrument.firstPendingId = instrument.updateId;
+    }
+    (bid ? instrument.pendingBids : instrument.pendingAsks)[tick] = qty;
+}
+
+void MockExchange::publishBookTicker(Instrument& instrument, uint64_t) {
+    if (instrument.bids.empty() || instrument.asks.empty()) {
+        return;
+    }
+    auto bid = instrument.bids.rbegin();
+    auto ask = instrument.asks.begin();
+    publish(instrument.bookTickerStream, fmt::format(R"({{"u":{},"s":"{}","b":"{}","B":"{}","a":"{}","A":"{}"}})",
+        instrument.updateId, instrument.symbol, price(instrument, bid->first), Qty::fromRaw(bid->second).to_str(),
+        price(instrument, ask->first), Qty::fromRaw(ask->second).to_str()));
+}
+
+void MockExchange::publishTrade(Instrument& instrument, uint64_t now) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    bool buyerMaker = unit(rng_) < 0.5;
+    const Book& book = buyerMaker ? instrument.bids : instrument.asks;
+    if (book.empty()) {
+        return;
+    }
+    int64_t tick = buyerMaker ? book.rbegin()->first : book.begin()->first;
+    int64_t available = buyerMaker ? book.rbegin()->second : book.begin()->second;
+    Qty quantity = Qty::fromRaw(std::max<int64_t>(1, static_cast<int64_t>(available * unit(rng_))));
+    uint64_t trades = std::uniform_int_distribution<uint64_t>(1, 3)(rng_);
+    publish(instrument.aggTradeStream, fmt::format(R"({{"e":"aggTrade","E":{},"s":"{}","a":{},"p":"{}","q":"{}","f":{},"l":{},"T":{},"m":{},"M":true}})",
+        now, instrument.symbol, instrument.aggTradeId, price(instrument, tick), quantity.to_str(),
+        instrument.tradeId, instrument.tradeId + trades - 1, now, buyerMaker));
+    ++instrument.aggTradeId;
+    instrument.tradeId += trades;
+}
+
+void MockExchange::publishDepth(Instrument& instrument, uint64_t now) {
+    if (instrument.firstPendingId == 0) {
+        return;
+    }
+    auto it = subscribers_.find(instrument.depthStream);
+    if (it != subscribers_.end() && !it->second.empty()) {
+        auto levels = [&instrument, this](auto begin, auto end) {
+            std::string out;
+            for (auto level = begin; level != end; ++level) {
+                out += fmt::format(R"({}["{}","{}"])", out.empty() ? "" : ",", price(instrument, level->first), Qty::fromRaw(level->second).to_str());
+            }
+            return out;
+        };
+        publish(instrument.depthStream, fmt::format(R"({{"e":"depthUpdate","E":{},"s":"{}","U":{},"u":{},"b":[{}],"a":[{}]}})",
+            now, instrument.symbol, instrument.firstPendingId, instrument.updateId,
+            levels(instrument.pendingBids.rbegin(), instrument.pendingBids.rend()),
+            levels(instrument.pendingAsks.begin(), instrument.pendingAsks.end())));
+    }
+    instrument.firstPendingId = 0;
+    instrument.pendingBids.clear();
+    instrument.pendingAsks.clear();
+}
+
+void MockExchange::publish(const std::string& stream, const std::string& data) {
+    auto it = subscribers_.find(stream);
+    if (it == subscribers_.end()) {
+        return;
+    }
+    std::string envelope;
+    for (const auto& subscriber : it->second) {
+        if (subscriber.combined) {
+            if (envelope.empty()) {
+                envelope = fmt::format(R"({{"stream":"{}","data":{}}})", stream, data);
+            }
+            send(subscriber.hdl, envelope);
+        } else {
+            send(subscriber.hdl, data);
+        }
+    }
+}
+
+void MockExchange::send(websocketpp::connection_hdl hdl, const std::string& payload) {
+    websocketpp::lib::error_code ec;
+    server_.send(hdl, payload, websocketpp::frame::opcode::text, ec);
+    if (!ec) {
+        ++messages_sent_;
+    }
+}
+
+MockExchange::Instrument& MockExchange::findInstrument(const std::string& symbol) {
+    auto it = instrument_index_.find(symbol);
+    if (it == instrument_index_.end()) {
+        throw ApiError(-1121, "Invalid symbol.");
+    }
+    return instruments_[it->second];
+}
+
+std::string MockExchange::price(const Instrument& instrument, int64_t tick) const {
+    return Price::fromRaw(tick * instrument.tickSize.raw()).to_str();
+}
+
+// <replay_dir>/<SYMBOL>/<date>/book.csv as written by the recorder
+void MockExchange::loadReplay(Instrument& instrument) {
+    std::string filename = config_.replayDir + "/" + instrument.symbol + "/" + config_.replayDate + "/book.csv";
+    std::ifstream file(filename);
+    if (!file) {
+        LOG_WARNING("[MOCK_EXCHANGE] No recording for {} at {}, generating quotes instead", instrument.symbol, filename);
+        return;
+    }
+    std::string line;
+    std::getline(file, line);  // header
+    while (std::getline(file, line)) {
+        std::vector<std::string_view> fields;
+        std::string_view rest(line);
+        for (size_t sep = rest.find(';'); sep != std::string_view::npos; sep = rest.find(';')) {
+            fields.push_back(rest.substr(0, sep));
+            rest.remove_prefix(sep + 1);
+        }
+        fields.push_back(rest);
+        Quote quote;
+        if (fields.size() >= 6 && Price::parse(fields[2], quote.bidPrice) && Qty::parse(fields[3], quote.bidQty)
+            && Price::parse(fields[4], quote.askPrice) && Qty::parse(fields[5], quote.askQty)) {
+            instrument.replay.push_back(quote);
+        }
+    }
+    LOG_INFO("[MOCK_EXCHANGE] Loaded {} quotes for {} from {}", instrument.replay.size(), instrument.symbol, filename);
+}
@@ -0,0 +1,61 @@
+// MockExchangeConfig.cpp
+#include "mock/MockExchangeConfig.h"
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/ini_parser.hpp>
+#include <boost/lexical_cast.hpp>
+#include <stdexcept>
+#include <sstream>
+
+namespace {
+    // "NAME:value,NAME:value"
+    std::vector<std::pair<std::string, double>> parseNamedValues(const std::string& text) {
+        std::vector<std::pair<std::string, double>> values;
+        std::stringstream entries(text);
+        std::string entry;
+        while (std::getline(entries, entry, ',')) {
+            if (entry.empty()) {
+                continue;
+            }
+            size_t colon = entry.find(':');
+            if (colon == std::string::npos) {
+                throw std::runtime_error("Expected NAME:value, got <" + entry + ">");
+            }
+            values.emplace_back(entry.substr(0, colon), boost::lexical_cast<double>(entry.substr(colon + 1)));
+        }
+        return values;
+    }
+}
+
+MockExchangeConfig loadMockExchangeConfig(const std::string& configFile) {
+    MockExchangeConfig config;
+    boost::property_tree::ptree pt;
+
+    try {
+        boost::property_tree::ini_parser::read_ini(configFile, pt);
+
+        config.listenPort = boost::lexical_cast<uint16_t>(pt.get("MOCK_EXCHANGE.listen_port", 9443));
+        config.certificateFile = pt.get<std::string>("MOCK_EXCHANGE.tls_certificate_file");
+        config.privateKeyFile = pt.get<std::string>("MOCK_EXCHANGE.tls_private_key_file");
+        config.symbols = parseNamedValues(pt.get("MOCK_EXCHANGE.symbols", "BTCUSDT:60000,ETHUSDT:3000,ETHBTC:0.05"));
+        config.balances = parseNamedValues(pt.get("MOCK_EXCHANGE.balances", "USDT:10000"));
+        config.eventRateHz = boost::lexical_cast<double>(pt.get("MOCK_EXCHANGE.event_rate_hz", 100));
+        config.tradeRatio = boost::lexical_cast<double>(pt.get("MOCK_EXCHANGE.trade_ratio", 0.2));
+        config.replayDir = pt.get("MOCK_EXCHANGE.replay_dir", "");
+        config.replayDate = pt.get("MOCK_EXCHANGE.replay_date", "");
+        config.apiLatencyUs = boost::lexical_cast<uint32_t>(pt.get("MOCK_EXCHANGE.api_latency_us", 0));
+        config.apiLatencyJitterUs = boost::lexical_cast<uint32_t>(pt.get("MOCK_EXCHANGE.api_latency_jitter_us", 0));
+        config.seed = boost::lexical_cast<uint64_t>(pt.get("MOCK_EXCHANGE.seed", 42));
+    } catch (const boost::property_tree::ini_parser_error& e) {
+        throw std::runtime_error("Failed to load config file: " + std::string(e.what()));
+    } catch (const boost::property_tree::ptree_bad_path& e) {
+        throw std::runtime_error("Missing parameter in config file: " + std::string(e.what()));
+    }
+
+    if (config.symbols.empty()) {
+        throw std::runtime_error("[MOCK_EXCHANGE] symbols must list at least one symbol.");
+    }
+    if (!config.replayDir.empty() && config.replayDate.empty()) {
+        throw std::runtime_error("[MOCK_EXCHANGE] replay_dir needs replay_date.");
+    }
+    return config;
+}
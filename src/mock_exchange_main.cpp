@@ -0,0 +1,50 @@
+#include "mock/MockExchange.h"
+#include "mock/MockExchangeConfig.h"
+#include <iostream>
+#include <string>
+#include <getopt.h>
+
+void printUsage(const std::string& programName) {
+    std::cout << "Usage: " << programName << " --configfile <path_to_ini>" << std::endl;
+    std::cout << "       --configfile: Path to the configuration INI file with a [MOCK_EXCHANGE] section." << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string configFile;
+
+    static struct option long_options[] = {
+        {"configfile", required_argument, 0, 'c'},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, "c:", long_options, &option_index)) != -1) {
+        switch (c) {
+            case 'c':
+                configFile = optarg;
+                break;
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (configFile.empty()) {
+        std::cerr << "Error: --configfile parameter is required." << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        MockExchangeConfig config = loadMockExchangeConfig(configFile);
+
+        MockExchange exchange(config);
+        exchange.run();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
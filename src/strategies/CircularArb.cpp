@@ -1,31 +1,44 @@
 #include "strategies/CircularArb.h"
 
 CircularArb::CircularArb(const CircularArbConfig& config, const BNBMarketConnectionConfig& mcConfig)
-    : startingAsset_(config.startingAsset), broker_(mcConfig), feeder_(mcConfig){
+    : startingAsset_(config.startingAsset), broker_(mcConfig), feeder_(mcConfig), executor_(broker_, config.execution){
+    if (config.orderBookTicks > 0) {
+        books_ = std::make_unique<BNBBookBuilder>(mcConfig, broker_, config.orderBookTicks);
+    }
     initialize();
 } 
 
+CircularArb::~CircularArb() {
+    // Fails the executor callbacks still pending while the executor is alive
+    broker_.stop();
+}
+
 void CircularArb::initialize() {
     LOG_INFO("[STRATEGY] CircularArb initialized with starting coin: {}", startingAsset_);
 
     broker_.start();
     feeder_.start();
+    if (books_) {
+        books_->start();
+    }
 
     LOG_INFO("[STRATEGY] Getting exchange information");
 
     request req = BNBRequests::General::exchangeInformation({});
-    std::string requestId = broker_.sendRequest(req.first, req.second);
-    nlohmann::json response = broker_.getResponseForId(requestId);
+    nlohmann::json response = broker_.sendRequest(req, RequestCosts::EXCHANGE_INFORMATION).get();
 
     auto exInfo = ExchangeInfo(response);
 
     std::vector<Symbol> symbolsList = exInfo.getSymbols();
+    registry_ = InstrumentRegistry(symbolsList);
+    marketData_.assign(registry_.size(), BookTickerMDFrame());
+    instrumentPaths_.assign(registry_.size(), {});
     stratPaths_ = computeArbitragePaths(symbolsList, startingAsset_, 3);
+    pathEpochs_.assign(stratPaths_.size(), 0);
 
     LOG_INFO("[STRATEGY] Getting account infromation");
     req = BNBRequests::Account::information();
-    requestId = broker_.sendRequest(req.first, req.second);
-    response = broker_.getResponseForId(requestId);
+    response = broker_.sendRequest(req, RequestCosts::ACCOUNT_INFORMATION).get();
 
     const json& balances = response["result"]["balances"];
     for (const auto& balance : balances) {
@@ -45,40 +58,84 @@ void CircularArb::initialize() {
 
     LOG_INFO("[STRATEGY] Initializing market data");
     std::set<std::string> relatedSymbols;
-    for (auto path: stratPaths_)
+    std::vector<Symbol> bookSymbols;
+    for (size_t pathIndex = 0; pathIndex < stratPaths_.size(); ++pathIndex)
     {
         std::string pathDescription;
-        for (auto order: path)
+        for (const auto& order: stratPaths_[pathIndex])
         {
-            relatedSymbols.insert(order.getSymbol().to_str());
+            if (relatedSymbols.insert(order.getSymbol().to_str()).second) {
+                bookSymbols.push_back(order.getSymbol());
+            }
+            instrumentPaths_[order.getSymbol().getId()].push_back(pathIndex);
             pathDescription += order.to_str() + " ";
         }
+        executor_.addPath(stratPaths_[pathIndex]);
         LOG_DEBUG("[STRATEGY] Arbitrage path : {}", pathDescription);
     }
 
-    req = BNBRequests::MarketData::symbolOrderBookTicker({relatedSymbols.begin(), relatedSymbols.end()});
-    requestId = broker_.sendRequest(req.first, req.second);
-    response = broker_.getResponseForId(requestId);
+    for (const auto& dataFrame : requestBookTickers({relatedSymbols.begin(), relatedSymbols.end()})) {
+        marketData_[dataFrame.instrumentId] = dataFrame;
+        LOG_DEBUG("Starting BookTicker : {}", dataFrame.to_str(registry_.getSymbol(dataFrame.instrumentId)));
+    }
+
+    feeder_.setInstrumentRegistry(registry_);
+    // Symbols left stale by a feeder reconnect are refreshed the same way
+    feeder_.setSnapshotProvider([this](const std::vector<InstrumentId>& instruments, BNBFeeder<BookTickerMDFrame>::SnapshotCallback done) {
+        std::vector<std::string> symbols;
+        for (InstrumentId instrument : instruments) {
+            symbols.push_back(registry_.getSymbol(instrument));
+        }
+        request req = BNBRequests::MarketData::symbolOrderBookTicker(symbols);
+        broker_.sendRequest(req, [this, done](nlohmann::json response) {
+            std::vector<BookTickerMDFrame> snapshot;
+            try {
+                snapshot = parseBookTickers(response);
+            } catch (const std::exception& e) {
+                LOG_ERROR("[STRATEGY] Invalid book tickers snapshot : {}", e.what());
+            }
+            done(std::move(snapshot));
+        }, RequestCosts::BOOK_TICKERS);
+    });
+    feeder_.subscribeToTickers({relatedSymbols.begin(), relatedSymbols.end()});
+    if (books_) {
+        books_->subscribe(registry_, bookSymbols);
+    }
+}
 
-    const json& data = response["result"];
+// Batched ticker.book snapshot over the broker
+std::vector<BookTickerMDFrame> CircularArb::requestBookTickers(const std::vector<std::string>& symbols) {
+    request req = BNBRequests::MarketData::symbolOrderBookTicker(symbols);
+    return parseBookTickers(broker_.sendRequest(req, RequestCosts::BOOK_TICKERS).get());
+}
+
+std::vector<BookTickerMDFrame> CircularArb::parseBookTickers(const nlohmann::json& response) const {
+    std::vector<BookTickerMDFrame> snapshot;
+    const json& data = response.at("result");
     for (const auto& json_data : data) {
         BookTickerMDFrame dataFrame;
-        dataFrame.symbol = json_data["symbol"].get<std::string>();
-        dataFrame.bestBidPrice = std::stod(json_data["bidPrice"].get<std::string>());
-        dataFrame.bestBidQty = std::stod(json_data["bidQty"].get<std::string>());
-        dataFrame.bestAskPrice = std::stod(json_data["askPrice"].get<std::string>());
-        dataFrame.bestAskQty = std::stod(json_data["askQty"].get<std::string>());
-        marketData_[dataFrame.symbol] = dataFrame;
-        LOG_DEBUG("Starting BookTicker : {}", dataFrame.to_str());
+        dataFrame.instrumentId = registry_.find(json_data["symbol"].get<std::string>());
+        if (dataFrame.instrumentId == INVALID_INSTRUMENT_ID)
+        {
+            continue;
+        }
+        dataFrame.bestBidPrice = Price::fromString(json_data["bidPrice"].get<std::string>());
+        dataFrame.bestBidQty = Qty::fromString(json_data["bidQty"].get<std::string>());
+        dataFrame.bestAskPrice = Price::fromString(json_data["askPrice"].get<std::string>());
+        dataFrame.bestAskQty = Qty::fromString(json_data["askQty"].get<std::string>());
+        snapshot.push_back(dataFrame);
     }
-
-    feeder_.subscribeToTickers({relatedSymbols.begin(), relatedSymbols.end()});
+    return snapshot;
 }
 
 void CircularArb::shutdown() {
     LOG_INFO("[STRATEGY] Shutting down Triangular Arbitrage Strategy...");
     broker_.stop();
     feeder_.stop();
+    if (books_) {
+        books_->stop();
+    }
+    executor_.logStats();
 }
 
 CircularArbConfig CircularArb::loadConfig(const std::string& configFile){
@@ -89,6 +146,9 @@ CircularArbConfig CircularArb::loadConfig(const std::string& configFile){
         boost::property_tree::ini_parser::read_ini(configFile, pt);
 
         config.startingAsset = pt.get<std::string>("CIRCULAR_ARB_STRATEGY.startingAsset");
+        config.execution.mode = parseExecutionMode(pt.get<std::string>("CIRCULAR_ARB_STRATEGY.executionMode", "PIPELINED"));
+        config.execution.testOrders = pt.get<bool>("CIRCULAR_ARB_STRATEGY.testOrders", true);
+        config.orderBookTicks = pt.get<size_t>("CIRCULAR_ARB_STRATEGY.orderBookTicks", 0);
     } catch (const boost::property_tree::ini_parser_error& e) {
         throw std::runtime_error("Failed to load config file: " + std::string(e.what()));
     } catch (const boost::property_tree::ptree_bad_path& e) {
@@ -174,34 +234,64 @@ std::optional<Signal> CircularArb::evaluatePath(std::vector<Order>& path) {
             return std::nullopt;
         }
 
-        if (marketData_.find(order.getSymbol().to_str()) == marketData_.end())
+        const BookTickerMDFrame& marketData = marketData_[order.getSymbol().getId()];
+        if (marketData.instrumentId == INVALID_INSTRUMENT_ID)
         {
             LOG_DEBUG("Market data still unavailale for [{}]", order.getSymbol().to_str());
             return std::nullopt;
         }
+        if (feeder_.isStale(marketData.instrumentId))
+        {
+            LOG_DEBUG("Market data stale for [{}], waiting for resync", order.getSymbol().to_str());
+            return std::nullopt;
+        }
 
         // base asset refers to the asset that is the quantity of a symbol.
         // quote asset refers to the asset that is the price of a symbol.
         // For the symbol XRPUSDC, USDC would be the quote asset.
         // For the symbol XRPUSDC, XRP would be the base asset.
 
-        const BookTickerMDFrame& marketData = marketData_[order.getSymbol().to_str()];
-
-        double orderPrice=0;
-        double orderQty=0;
+        Price orderPrice;
+        Qty orderQty;
 
-        if (order.getWay() == Way::SELL)
+        if (books_)
+        {
+            // Sized against the L2 book, the price is the worst level the leg reaches
+            const BNBOrderBook* book = books_->getBook(marketData.instrumentId);
+            if (!book)
+            {
+                LOG_DEBUG("Order book of [{}] not synced yet", order.getSymbol().to_str());
+                return std::nullopt;
+            }
+            bool sell = order.getWay() == Way::SELL;
+            double received = 0;
+            if (sell) {
+                orderQty = order.getSymbol().getFilter().roundQty(Qty::fromDouble(startingAssetQty));
+            }
+            if (!sweep(sell ? book->bids() : book->asks(), order.getWay(), sell ? orderQty.toDouble() : startingAssetQty, received, orderPrice))
+            {
+                LOG_DEBUG("Not enough depth on [{}] for {} {}", order.getSymbol().to_str(), startingAssetQty, order.getStartingAsset());
+                return std::nullopt;
+            }
+            if (sell) {
+                resultingAssetQty = received;
+            } else {
+                orderQty = order.getSymbol().getFilter().roundQty(Qty::fromDouble(received));
+                resultingAssetQty = orderQty.toDouble();
+            }
+        }
+        else if (order.getWay() == Way::SELL)
         {
             // sell to the bid 
-            orderQty = order.getSymbol().getFilter().roundQty(startingAssetQty);
-            resultingAssetQty = orderQty * marketData.bestBidPrice;
+            orderQty = order.getSymbol().getFilter().roundQty(Qty::fromDouble(startingAssetQty));
+            resultingAssetQty = orderQty.toDouble() * marketData.bestBidPrice.toDouble();
             orderPrice=marketData.bestBidPrice;
         }
-        if (order.getWay() == Way::BUY)
+        else if (order.getWay() == Way::BUY)
         {
             // buy from the ask 
-            orderQty = order.getSymbol().getFilter().roundQty(startingAssetQty/ marketData.bestAskPrice);
-            resultingAssetQty = orderQty;
+            orderQty = order.getSymbol().getFilter().roundQty(Qty::fromDouble(startingAssetQty / marketData.bestAskPrice.toDouble()));
+            resultingAssetQty = orderQty.toDouble();
             orderPrice= marketData.bestAskPrice;
         }
 
@@ -228,18 +318,58 @@ std::optional<Signal> CircularArb::evaluatePath(std::vector<Order>& path) {
     }
 }
 
+bool CircularArb::sweep(const PriceLadder& side, Way way, double amount, double& received, Price& worstPrice) {
+    size_t count = side.top(sweepLevels_.data(), sweepLevels_.size());
+    received = 0;
+    for (size_t i = 0; i < count && amount > 0; ++i) {
+        double price = sweepLevels_[i].price.toDouble();
+        double qty = sweepLevels_[i].qty.toDouble();
+        worstPrice = sweepLevels_[i].price;
+        if (way == Way::SELL) {
+            double sold = std::min(amount, qty);
+            received += sold * price;
+            amount -= sold;
+        } else {
+            double spent = std::min(amount, qty * price);
+            received += spent / price;
+            amount -= spent;
+        }
+    }
+    return amount <= 0;
+}
+
 // Handle incoming market data
 std::optional<Signal> CircularArb::onMarketData(const BookTickerMDFrame& data) {
-    marketData_[data.symbol] = data;
+    marketData_[data.instrumentId] = data;
+    return evaluatePaths(instrumentPaths_[data.instrumentId]);
+}
+
+std::optional<Signal> CircularArb::onMarketData(const std::vector<BookTickerMDFrame>& batch) {
+    ++epoch_;
+    dirtyPaths_.clear();
+    for (const auto& data : batch) {
+        marketData_[data.instrumentId] = data;
+        for (size_t pathIndex : instrumentPaths_[data.instrumentId]) {
+            if (pathEpochs_[pathIndex] != epoch_) {
+                pathEpochs_[pathIndex] = epoch_;
+                dirtyPaths_.push_back(pathIndex);
+            }
+        }
+    }
+    return evaluatePaths(dirtyPaths_);
+}
+
+// Best signal over the given paths
+std::optional<Signal> CircularArb::evaluatePaths(const std::vector<size_t>& paths) {
     double maxPnl=0;
     std::optional<Signal> outSignal;
-    for (auto& path : stratPaths_) {
-        if (std::any_of(path.begin(), path.end(), [&data](const Order& order) { return order.getSymbol().to_str() == data.symbol; })) {
-            std::optional<Signal> sig = evaluatePath(path);
-            if ((sig.has_value()) && (sig->pnl > maxPnl))
-            {
-                outSignal = sig;
-            }
+    for (size_t pathIndex : paths) {
+        std::optional<Signal> sig = evaluatePath(stratPaths_[pathIndex]);
+        if ((sig.has_value()) && (sig->pnl > maxPnl))
+        {
+            maxPnl = sig->pnl;
+            sig->pathIndex = pathIndex;
+            outSignal = sig;
         }
     }
     return outSignal;
@@ -247,24 +377,25 @@ std::optional<Signal> CircularArb::onMarketData(const BookTickerMDFrame& data) {
 
 
 void CircularArb::run() {
+    std::vector<BookTickerMDFrame> batch;
+    batch.reserve(MAX_BATCH_SIZE);
     while (true) {
         try {
-            auto update = feeder_.getUpdate();
-            std::optional<Signal> sig = onMarketData(update);
+            feeder_.drain(batch, MAX_BATCH_SIZE);
+            if (books_) {
+                books_->poll();
+            }
+            std::optional<Signal> sig = onMarketData(batch);
             if (sig.has_value())
             {
-                LOG_INFO("Detected a trading signal, theo PNL : {}, description : {}", sig->pnl, sig->description);
-                for (auto& order: sig->orders)
+                if (executor_.execute(*sig))
                 {
-                    LOG_INFO("[STRATEGY] Executing order {}", order.to_str());
-                    std::string symbol = "SYM";
-                    double quantity = 0.0;                    
-                    request req = BNBRequests::Trading::testNewOrder(order.getSymbol().to_str(), order.getWay(), order.getType(), order.getQty());
-                    std::string requestId = broker_.sendRequest(req.first, req.second);
-                    nlohmann::json response = broker_.getResponseForId(requestId);
-                    LOG_WARNING("Trade test response: {}", response.dump());
+                    LOG_INFO("Detected a trading signal, theo PNL : {}, description : {}", sig->pnl, sig->description);
+                }
+                else
+                {
+                    LOG_DEBUG("[STRATEGY] Signal skipped while the previous one executes : {}", sig->description);
                 }
-
             }
         } catch (const std::exception& e) {
             LOG_ERROR("Error in Circular Arb loop: {}", e.what());